@@ -99,6 +99,36 @@ Board::Board() {
     reset();
 }
 
+// Deep copy so search threads can each work on their own board.
+// Only the accumulator entries up to the current ply are copied, the rest are rebuilt lazily.
+Board::Board(const Board& other) {
+    accStack = std::make_unique<std::array<Accumulator, 2>[]>(MAX_GAME_PLY);
+    accValid = std::make_unique<bool[]>(MAX_GAME_PLY);
+    *this = other;
+}
+
+Board& Board::operator=(const Board& other) {
+    if (this == &other) return *this;
+
+    std::memcpy(piece, other.piece, sizeof(piece));
+    std::memcpy(color, other.color, sizeof(color));
+    std::memcpy(mailbox, other.mailbox, sizeof(mailbox));
+    hash = other.hash;
+    castling = other.castling;
+    enPassant = other.enPassant;
+    stm = other.stm;
+    halfMoveClock = other.halfMoveClock;
+    moveHistory = other.moveHistory;
+    undoStack = other.undoStack;
+
+    const size_t plies = undoStack.size() + 1;
+    for (size_t i = 0; i < plies; i++) {
+        accValid[i] = other.accValid[i];
+        if (accValid[i]) accStack[i] = other.accStack[i];
+    }
+    return *this;
+}
+
 void Board::reset() {
     set_start_position(*this);
 
@@ -344,10 +374,10 @@ void Board::makeMove(Move move) {
     if (st.capturedPiece == W_ROOK && toSq == 0) {
         castling &= ~CASTLE_WQ;
     }
-    if (st.capturedPiece == B_ROOK && toSq == 56) {
+    if (st.capturedPiece == B_ROOK && toSq == 63) {
         castling &= ~CASTLE_BK;
     }
-    if (st.capturedPiece == B_ROOK && toSq == 63) {
+    if (st.capturedPiece == B_ROOK && toSq == 56) {
         castling &= ~CASTLE_BQ;
     }
 
@@ -474,7 +504,7 @@ void Board::loadFEN(const std::string& fen) {
         this->enPassant = enPassantField[0] - 'a';
         int epRow = stm == 0 ? 2 : 5;
         int epSq = row_col_to_sq(epRow, this->enPassant);
-        if (!is_pawn_attack_possible(*this, stm == 0 ? false : true, epSq)) {
+        if (!is_pawn_attack_possible(*this, stm == WHITE, epSq)) { // the side to move captures
             this->enPassant = -1;
         }
     } else {
@@ -589,7 +619,7 @@ Move uci_to_move(const std::string& uci, const Board& board) {
 }
 
 Zobrist::Zobrist() {
-    uint64_t seed = 0xC0FFEE1234ABCDEFULL;
+    uint64_t seed = SEED;
     for (int p = 0; p < 12; p++) {
         for (int sq = 0; sq < 64; sq++) {
             piece[p][sq] = splitmix64(seed);
@@ -203,6 +203,8 @@ struct Board {
     std::unique_ptr<bool[]> accValid;
 
     Board();
+    Board(const Board& other);
+    Board& operator=(const Board& other);
     void reset();
     void loadFEN(const std::string& fen);
     void makeMove(Move move);
@@ -240,9 +242,13 @@ inline void king_square(const Board& board, bool white, int& outSq) {
     outSq = sq;
 }
 
-// Move generation functions
+// Move generation functions. In check get_all_moves runs a dedicated evasion generator that
+// only looks at the king and the checker's ray.
 void get_all_moves(Board& board, Move moves[], int& moveCount);
 void get_capture_moves(Board& board, Move moves[], int& moveCount);
+void get_quiet_moves(Board& board, Move moves[], int& moveCount);
+// Whether `move` is one of the legal moves in this position (TT moves and killers are only hints).
+bool is_legal_move(const Board& board, Move move);
 
 // Attack detection
 bool is_square_attacked(const Board& board, int sq, bool isWhiteAttacker);
@@ -259,6 +265,8 @@ struct Zobrist {
     uint64_t epFile[9]{};
     uint64_t side{};
 
+    static constexpr uint64_t SEED = 0xC0FFEE1234ABCDEFULL; // also recorded in saved hash files
+
     static uint64_t splitmix64(uint64_t& x);
     Zobrist();
 };
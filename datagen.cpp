@@ -1,6 +1,7 @@
 #include "datagen.h"
 #include "evaluation.h"
 #include "search.h"
+#include "numa.h"
 #include <iostream>
 #include <fstream>
 #include <random>
@@ -188,7 +189,8 @@ struct FenRecord {
     int16_t score; // centipawns, white's perspective (positive = white better)
 };
 
-int play_selfgen_game(std::ofstream& out_file, int soft_nodes, bool use_book, std::mt19937_64& gen) {
+// The worker keeps its TT and history across the plies of a game, the caller resets both between games.
+int play_selfgen_game(SearchWorker& worker, std::ofstream& out_file, int soft_nodes, bool use_book, std::mt19937_64& gen) {
     Board pos;
     pos.reset();
 
@@ -210,6 +212,11 @@ int play_selfgen_game(std::ofstream& out_file, int soft_nodes, bool use_book, st
     std::vector<FenRecord> fen_list;
     fen_list.reserve(MAX_GAME_PLYS);
 
+    // Positions played so far, so the search sees repetitions like it does in a UCI game
+    std::vector<uint64_t> game_history;
+    game_history.reserve(MAX_GAME_PLYS + 1);
+    game_history.push_back(position_key(pos));
+
     double result = 0.5;
     int win_adj_count = 0;
     int draw_adj_count = 0;
@@ -232,10 +239,10 @@ int play_selfgen_game(std::ofstream& out_file, int soft_nodes, bool use_book, st
 
         std::string current_fen = get_fen(pos);
 
-        setSoftNodeLimit(soft_nodes);
+        worker.setSoftNodeLimit(soft_nodes);
         int16_t raw_score = 0;
-        Move best_move = getBestMove(pos, 128, -1, {}, 0, true, raw_score);
-        setSoftNodeLimit(-1);
+        Move best_move = worker.getBestMove(pos, 128, -1, game_history, 0, true, raw_score);
+        worker.setSoftNodeLimit(-1);
 
         int16_t white_score = (pos.stm == WHITE) ? raw_score : static_cast<int16_t>(-raw_score);
 
@@ -270,6 +277,7 @@ int play_selfgen_game(std::ofstream& out_file, int soft_nodes, bool use_book, st
 
         if (best_move == 0) break;
         pos.makeMove(best_move);
+        game_history.push_back(position_key(pos));
         game_ply++;
     }
 
@@ -281,7 +289,9 @@ int play_selfgen_game(std::ofstream& out_file, int soft_nodes, bool use_book, st
     return static_cast<int>(fen_list.size());
 }
 
-void datagen_worker(int thread_id, uint64_t target_games, int soft_nodes, bool use_book, uint64_t seed) {
+void datagen_worker(int thread_id, uint64_t target_games, int soft_nodes, bool use_book, uint64_t seed, int hash_mb) {
+    numa_bind_thread(thread_id); // no-op unless NUMA mode is on
+
     // Each thread gets a unique seed derived from the base seed + thread_id
     std::mt19937_64 gen(seed + static_cast<uint64_t>(thread_id));
 
@@ -289,13 +299,23 @@ void datagen_worker(int thread_id, uint64_t target_games, int soft_nodes, bool u
     trim_incomplete_last_line(out_filename);
     std::ofstream out_file(out_filename, std::ios::app);
 
+    // Private search state and TT so the workers don't race on (or evict) each other's entries.
+    // Allocated after binding, so the table lands on this thread's NUMA node.
+    auto worker = std::make_unique<SearchWorker>();
+    TranspositionTable tt(hash_mb, false);
+    worker->setTranspositionTable(&tt);
+
     while (true) {
         uint64_t current_game = games_played_count.load();
         if (target_games > 0 && current_game >= target_games) break;
 
         games_played_count++;
 
-        int new_fens = play_selfgen_game(out_file, soft_nodes, use_book, gen);
+        // Games must not depend on each other (or on the order a thread happened to play them in)
+        tt.clear();
+        worker->clearQSearchTable();
+        worker->clearHistory();
+        int new_fens = play_selfgen_game(*worker, out_file, soft_nodes, use_book, gen);
         total_fens_generated += new_fens;
 
         if (games_played_count % 100 == 0) {
@@ -305,7 +325,7 @@ void datagen_worker(int thread_id, uint64_t target_games, int soft_nodes, bool u
     }
 }
 
-void start_datagen(int num_threads, uint64_t target_games, int soft_nodes, bool use_book, uint64_t seed) {
+void start_datagen(int num_threads, uint64_t target_games, int soft_nodes, bool use_book, uint64_t seed, int hash_mb) {
     if (use_book) {
         load_book("UHO_Lichess_4852_v1.epd");
     }
@@ -313,11 +333,12 @@ void start_datagen(int num_threads, uint64_t target_games, int soft_nodes, bool
     std::cout << "Starting datagen: threads=" << num_threads
               << " games=" << target_games
               << " soft_nodes=" << soft_nodes
-              << " seed=" << seed << std::endl;
+              << " seed=" << seed
+              << " hash=" << hash_mb << "MB" << std::endl;
 
     std::vector<std::thread> threads;
     for (int i = 0; i < num_threads; ++i) {
-        threads.emplace_back(datagen_worker, i, target_games, soft_nodes, use_book, seed);
+        threads.emplace_back(datagen_worker, i, target_games, soft_nodes, use_book, seed, hash_mb);
     }
 
     for (auto& t : threads) {
@@ -18,8 +18,9 @@ void load_book(const std::string& filename);
 // soft_nodes  : soft node limit per position search
 // use_book    : whether to load positions from book
 // seed        : base RNG seed (thread_id is added to it for uniqueness)
-void datagen_worker(int thread_id, uint64_t target_games, int soft_nodes, bool use_book, uint64_t seed);
+// hash_mb     : size of the worker's private TT, cleared between games
+void datagen_worker(int thread_id, uint64_t target_games, int soft_nodes, bool use_book, uint64_t seed, int hash_mb);
 
-void start_datagen(int num_threads, uint64_t target_games, int soft_nodes, bool use_book, uint64_t seed);
+void start_datagen(int num_threads, uint64_t target_games, int soft_nodes, bool use_book, uint64_t seed, int hash_mb);
 
 #endif
@@ -2,23 +2,20 @@
 #include <cstring>
 #include <algorithm>
 
-int historyTable[2][64][64]; // color x fromSquare x toSquare
-int conhistTable[12][64][12][64]; // [prevPiece][prevTo][currPiece][currTo]
-thread_local MoveInfo moveStack[MAX_PLY];
 constexpr int HISTORY_MAX = 16384;
 
-void clear_history() {
+void History::clear_history() {
     std::memset(historyTable, 0, sizeof(historyTable));
     std::memset(conhistTable, 0, sizeof(conhistTable));
 }
 
-void reset_movestack() {
+void History::reset_movestack() {
     for (int i = 0; i < MAX_PLY; ++i) {
         moveStack[i] = {-1, -1};
     }
 }
 
-static void update_conhist(int piece, int to, int bonus, int ply) {
+void History::update_conhist(int piece, int to, int bonus, int ply) {
     constexpr int offsets[] = {1, 2, 4};
     for (int offset : offsets) {
         if (ply >= offset && moveStack[ply - offset].piece >= 0) {
@@ -30,7 +27,7 @@ static void update_conhist(int piece, int to, int bonus, int ply) {
     }
 }
 
-int get_conhist_score(int piece, int to, int ply) {
+int History::get_conhist_score(int piece, int to, int ply) const {
     int score = 0;
     constexpr int offsets[] = {1, 2, 4};
     for (int offset : offsets) {
@@ -43,7 +40,7 @@ int get_conhist_score(int piece, int to, int ply) {
     return score;
 }
 
-void update_history(const Board& board, int color, int fromSq, int toSq, int depth, const Move badQuiets[256], const int& badQuietCount, int ply) { 
+void History::update_history(const Board& board, int color, int fromSq, int toSq, int depth, const Move badQuiets[256], const int& badQuietCount, int ply) { 
 
     int bonus = std::min(10 + 200 * depth, 4096);
 
@@ -75,6 +72,6 @@ void update_history(const Board& board, int color, int fromSq, int toSq, int dep
     }
 }
 
-int get_history_score(int color, int fromSq, int toSq) {
+int History::get_history_score(int color, int fromSq, int toSq) const {
     return historyTable[color][fromSq][toSq];
 }
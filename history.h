@@ -8,15 +8,20 @@ struct MoveInfo {
     int to;    // 0-63, -1 for invalid
 };
 
-// History table: [color][fromSquare][toSquare]
-extern int historyTable[2][64][64];
-extern int conhistTable[12][64][12][64]; // [prevPiece][prevTo][currPiece][currTo]
-extern thread_local MoveInfo moveStack[MAX_PLY];
+// Move ordering history owned by a single SearchWorker, so threads never write into each other's tables.
+struct History {
+    int historyTable[2][64][64];          // [color][fromSquare][toSquare]
+    int conhistTable[12][64][12][64];     // [prevPiece][prevTo][currPiece][currTo]
+    MoveInfo moveStack[MAX_PLY];
 
-void clear_history();
-void reset_movestack();
-void update_history(const Board& board, int color, int fromSq, int toSq, int depth, const Move badQuiets[256], const int& badQuietCount, int ply);
-int get_history_score(int color, int fromSq, int toSq);
-int get_conhist_score(int piece, int to, int ply);
+    void clear_history();
+    void reset_movestack();
+    void update_history(const Board& board, int color, int fromSq, int toSq, int depth, const Move badQuiets[256], const int& badQuietCount, int ply);
+    int get_history_score(int color, int fromSq, int toSq) const;
+    int get_conhist_score(int piece, int to, int ply) const;
 
-#endif
\ No newline at end of file
+private:
+    void update_conhist(int piece, int to, int bonus, int ply);
+};
+
+#endif
@@ -4,6 +4,10 @@
 
 namespace {
 
+// Which part of the legal moves to generate. Captures include en passant and capturing
+// promotions, quiets the pushes, quiet promotions and castling.
+enum GenType { GEN_ALL, GEN_CAPTURES, GEN_QUIETS };
+
 inline int get_promo_flag(int promo_piece, bool is_capture) {
     int flag = 8; // Base flag for promotion
     if (promo_piece == BISHOP) flag = FLAG_PROMO_BISHOP;
@@ -18,27 +22,6 @@ inline void push_move(Move* moves, int fromSq, int toSq, int flag = 0) {
     *moves = static_cast<Move>((flag << 12) | (toSq << 6) | fromSq);
 }
 
-inline int piece_on_square_bb(const Board& board, int sq) {
-    Bitboard mask = 1ULL << sq;
-    if (board.color[WHITE] & mask) {
-        for (int i = 0; i < 6; i++) {
-            if (board.piece[i] & mask) return i + 1;  // W_PAWN=1 to W_KING=6
-        }
-        return 0;
-    }
-    if (board.color[BLACK] & mask) {
-        for (int i = 0; i < 6; i++) {
-            if (board.piece[i] & mask) return i + 7;  // B_PAWN=7 to B_KING=12
-        }
-        return 0;
-    }
-    return 0;
-}
-
-inline bool is_king_piece(int piece) {
-    return piece_type(piece) == KING;
-}
-
 inline Bitboard board_occupancy(const Board& board) {
     return board.color[WHITE] | board.color[BLACK];
 }
@@ -69,40 +52,186 @@ inline bool is_square_attacked_bb(const Board& board, int sq, bool byWhite) {
     return false;
 }
 
-} // namespace
+// between[a][b]: the squares strictly between two aligned squares, line[a][b]: the whole line
+// through both. Both are empty for squares that don't share a rank, file or diagonal.
+struct LineTables {
+    Bitboard between[64][64];
+    Bitboard line[64][64];
+
+    LineTables() {
+        for (int a = 0; a < 64; a++) {
+            for (int b = 0; b < 64; b++) {
+                between[a][b] = 0;
+                line[a][b] = 0;
+                if (a == b) continue;
+                const Bitboard ends = (1ULL << a) | (1ULL << b);
+                if (get_rook_attacks(a, 0) & (1ULL << b)) {
+                    between[a][b] = get_rook_attacks(a, 1ULL << b) & get_rook_attacks(b, 1ULL << a);
+                    line[a][b] = (get_rook_attacks(a, 0) & get_rook_attacks(b, 0)) | ends;
+                } else if (get_bishop_attacks(a, 0) & (1ULL << b)) {
+                    between[a][b] = get_bishop_attacks(a, 1ULL << b) & get_bishop_attacks(b, 1ULL << a);
+                    line[a][b] = (get_bishop_attacks(a, 0) & get_bishop_attacks(b, 0)) | ends;
+                }
+            }
+        }
+    }
+};
+
+// Built on first use, the slider tables are initialised by then.
+const LineTables& line_tables() {
+    static const LineTables tables;
+    return tables;
+}
+
+// Everything legality depends on, computed once per position instead of making every move.
+struct MoveGenInfo {
+    int us;
+    int them;
+    int kingSq;
+    Bitboard own;
+    Bitboard opp;          // opponent pieces except the king, which is never captured
+    Bitboard occ;
+    Bitboard checkers;
+    Bitboard pinned;       // our pieces that may only move along the line to their pinner
+    Bitboard kingDanger;   // squares the opponent attacks with our king lifted off the board
+    Bitboard checkMask;    // destinations that answer a single check (capture or block), all squares otherwise
+};
+
+Bitboard attacked_by(const Board& board, int side, Bitboard occ) {
+    const Bitboard pieces = board.color[side];
+    Bitboard attacks = 0;
+
+    Bitboard pawns = board.piece[PAWN - 1] & pieces;
+    while (pawns) {
+        attacks |= pawn_attacks[side][lsb(pawns)];
+        pawns &= pawns - 1;
+    }
+    Bitboard knights = board.piece[KNIGHT - 1] & pieces;
+    while (knights) {
+        attacks |= knight_attacks[lsb(knights)];
+        knights &= knights - 1;
+    }
+    Bitboard diagonal = (board.piece[BISHOP - 1] | board.piece[QUEEN - 1]) & pieces;
+    while (diagonal) {
+        attacks |= get_bishop_attacks(lsb(diagonal), occ);
+        diagonal &= diagonal - 1;
+    }
+    Bitboard straight = (board.piece[ROOK - 1] | board.piece[QUEEN - 1]) & pieces;
+    while (straight) {
+        attacks |= get_rook_attacks(lsb(straight), occ);
+        straight &= straight - 1;
+    }
+    Bitboard kings = board.piece[KING - 1] & pieces;
+    if (kings) attacks |= king_attacks[lsb(kings)];
+    return attacks;
+}
+
+MoveGenInfo analyse_position(const Board& board) {
+    const LineTables& lines = line_tables();
+    MoveGenInfo info;
+    info.us = board.stm;
+    info.them = other_color(board.stm);
+    info.own = board.color[info.us];
+    info.occ = board_occupancy(board);
+    info.opp = board.color[info.them] & ~board.piece[KING - 1];
+    const Bitboard kingBB = board.piece[KING - 1] & info.own;
+    info.kingSq = kingBB ? lsb(kingBB) : -1;
+    info.checkers = 0;
+    info.pinned = 0;
+    info.kingDanger = 0;
+    info.checkMask = ~0ULL;
+    if (info.kingSq == -1) return info;
+
+    const int ksq = info.kingSq;
+    const Bitboard theirs = board.color[info.them];
+    const Bitboard diagonal = (board.piece[BISHOP - 1] | board.piece[QUEEN - 1]) & theirs;
+    const Bitboard straight = (board.piece[ROOK - 1] | board.piece[QUEEN - 1]) & theirs;
+
+    info.checkers = (pawn_attacks[info.us][ksq] & board.piece[PAWN - 1] & theirs)
+                  | (knight_attacks[ksq] & board.piece[KNIGHT - 1] & theirs)
+                  | (get_bishop_attacks(ksq, info.occ) & diagonal)
+                  | (get_rook_attacks(ksq, info.occ) & straight);
+
+    // Sliders that would attack the king through our pieces alone: with exactly one of ours in
+    // between, that piece is pinned.
+    Bitboard snipers = (get_bishop_attacks(ksq, theirs) & diagonal) | (get_rook_attacks(ksq, theirs) & straight);
+    while (snipers) {
+        const int sniper = lsb(snipers);
+        snipers &= snipers - 1;
+        const Bitboard blockers = lines.between[ksq][sniper] & info.occ;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & info.own)) info.pinned |= blockers;
+    }
+
+    info.kingDanger = attacked_by(board, info.them, info.occ ^ kingBB);
+    if (info.checkers && !(info.checkers & (info.checkers - 1))) {
+        info.checkMask = info.checkers | lines.between[ksq][lsb(info.checkers)];
+    }
+    return info;
+}
+
+// En passant removes two pieces from one rank, which a pin mask can't describe (the
+// "both pawns between king and rook" case), so it is the one move tested on the resulting occupancy.
+bool en_passant_legal(const Board& board, const MoveGenInfo& info, int from, int to) {
+    const int capSq = to + (info.us == WHITE ? -8 : 8);
+    const Bitboard capBB = 1ULL << capSq;
+    const Bitboard theirs = board.color[info.them];
+    const Bitboard diagonal = (board.piece[BISHOP - 1] | board.piece[QUEEN - 1]) & theirs;
+    const Bitboard straight = (board.piece[ROOK - 1] | board.piece[QUEEN - 1]) & theirs;
+
+    // A knight (or another pawn) giving check is still there afterwards
+    if (info.checkers & ~capBB & ~(diagonal | straight)) return false;
+
+    const Bitboard occ = (info.occ ^ (1ULL << from) ^ capBB) | (1ULL << to);
+    return !(get_bishop_attacks(info.kingSq, occ) & diagonal) && !(get_rook_attacks(info.kingSq, occ) & straight);
+}
+
+// Destinations a piece on `from` may use: pinned pieces stay on the line to their king.
+inline Bitboard pin_mask(const MoveGenInfo& info, int from) {
+    return (info.pinned & (1ULL << from)) ? line_tables().line[info.kingSq][from] : ~0ULL;
+}
+
+// Destination squares for the pieces other than pawns, before check and pin masks.
+inline Bitboard gen_targets(const Board& board, const MoveGenInfo& info, GenType gen) {
+    if (gen == GEN_CAPTURES) return info.opp;
+    if (gen == GEN_QUIETS) return ~info.occ;
+    return ~info.own & ~board.piece[KING - 1];
+}
 
-void generate_pawn_moves_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
+} // namespace
 
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[whiteToMove ? BLACK : WHITE];
-    Bitboard pawns = board.piece[PAWN - 1] & own;
-    Bitboard empty = ~(own | opp);
+void generate_pawn_moves_bb(const Board& board, const MoveGenInfo& info, Move* moves, int& moveCount, GenType gen) {
+    const bool whiteToMove = info.us == WHITE;
+    const Bitboard empty = ~info.occ;
+    Bitboard pawns = board.piece[PAWN - 1] & info.own;
 
     while (pawns) {
         int from = lsb(pawns);
         pawns &= pawns - 1;
+        const Bitboard allowed = info.checkMask & pin_mask(info, from);
 
         int to = whiteToMove ? (from + 8) : (from - 8);
-        if (to >= 0 && to < 64) {
+        if (gen != GEN_CAPTURES && to >= 0 && to < 64) {
             Bitboard toMask = 1ULL << to;
             if (empty & toMask) {
                 bool isPromo = whiteToMove ? (from >= 48) : (from <= 15);
                 if (isPromo) {
-                    for (int promo : {QUEEN, ROOK, BISHOP, KNIGHT}) {
-                        push_move(moves + moveCount, from, to, get_promo_flag(promo, false));
-                        moveCount++;
+                    if (allowed & toMask) {
+                        for (int promo : {QUEEN, ROOK, BISHOP, KNIGHT}) {
+                            push_move(moves + moveCount, from, to, get_promo_flag(promo, false));
+                            moveCount++;
+                        }
                     }
                 } else {
-                    push_move(moves + moveCount, from, to, FLAG_QUIET);
-                    moveCount++;
+                    if (allowed & toMask) {
+                        push_move(moves + moveCount, from, to, FLAG_QUIET);
+                        moveCount++;
+                    }
 
                     bool onStartRank = whiteToMove ? (from >= 8 && from <= 15) : (from >= 48 && from <= 55);
                     if (onStartRank) {
                         int to2 = whiteToMove ? (from + 16) : (from - 16);
                         Bitboard to2Mask = 1ULL << to2;
-                        if (empty & to2Mask) {
+                        if (empty & allowed & to2Mask) {
                             push_move(moves + moveCount, from, to2, FLAG_DOUBLE_PAWN);
                             moveCount++;
                         }
@@ -111,13 +240,13 @@ void generate_pawn_moves_bb(const Board& board, Move* moves, int& moveCount) {
             }
         }
 
-        Bitboard attacks = pawn_attacks[us][from] & opp;
+        if (gen == GEN_QUIETS) continue;
+
+        Bitboard attacks = pawn_attacks[info.us][from] & info.opp & allowed;
         while (attacks) {
             int capSq = lsb(attacks);
             attacks &= attacks - 1;
-            int captured = piece_on_square_bb(board, capSq);
-            if (is_king_piece(captured)) continue;
-            
+
             bool isPromo = whiteToMove ? (capSq >= 56) : (capSq <= 7);
             if (isPromo) {
                 for (int promo : {QUEEN, ROOK, BISHOP, KNIGHT}) {
@@ -133,7 +262,7 @@ void generate_pawn_moves_bb(const Board& board, Move* moves, int& moveCount) {
         if (board.enPassant != -1) {
             int epRow = whiteToMove ? 2 : 5;
             int epSq = row_col_to_sq(epRow, board.enPassant);
-            if (pawn_attacks[us][from] & (1ULL << epSq)) {
+            if ((pawn_attacks[info.us][from] & (1ULL << epSq)) && en_passant_legal(board, info, from, epSq)) {
                 push_move(moves + moveCount, from, epSq, FLAG_EN_PASSANT);
                 moveCount++;
             }
@@ -141,461 +270,229 @@ void generate_pawn_moves_bb(const Board& board, Move* moves, int& moveCount) {
     }
 }
 
-void generate_knight_moves_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-    const int them = whiteToMove ? BLACK : WHITE;
+// Knights, bishops, rooks and queens onto `targets`.
+void generate_piece_moves_bb(const Board& board, const MoveGenInfo& info, int type, Bitboard targets, Move* moves, int& moveCount) {
+    Bitboard pieces = board.piece[type - 1] & info.own;
 
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[them];
-    Bitboard knights = board.piece[KNIGHT - 1] & own;
+    while (pieces) {
+        int from = lsb(pieces);
+        pieces &= pieces - 1;
 
-    while (knights) {
-        int from = lsb(knights);
-        knights &= knights - 1;
-
-        Bitboard targets = knight_attacks[from] & ~own;
-        while (targets) {
-            int to = lsb(targets);
-            targets &= targets - 1;
-            
-            bool isCapture = (opp & (1ULL << to)) != 0;
-            
-            if (isCapture) {
-                int captured = piece_on_square_bb(board, to);
-                if (is_king_piece(captured)) continue; 
-
-                push_move(moves + moveCount, from, to, FLAG_CAPTURE); 
-                moveCount++;
-            } else {
-                push_move(moves + moveCount, from, to, 0); 
-                moveCount++;
-            }
-        }
-    }
-}
-
-void generate_bishop_moves_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-    const int them = whiteToMove ? BLACK : WHITE;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[them];
-    Bitboard bishops = board.piece[BISHOP - 1] & own;
-    Bitboard occ = board_occupancy(board);
-
-    while (bishops) {
-        int from = lsb(bishops);
-        bishops &= bishops - 1;
-
-        Bitboard targets = get_bishop_attacks(from, occ) & ~own;
-        while (targets) {
-            int to = lsb(targets);
-            targets &= targets - 1;
-            
-            bool isCapture = (opp & (1ULL << to)) != 0;
-            if (isCapture) {
-                int captured = piece_on_square_bb(board, to);
-                if (is_king_piece(captured)) continue;
-                push_move(moves + moveCount, from, to, FLAG_CAPTURE);
-                moveCount++;
-            } else {
-                push_move(moves + moveCount, from, to, FLAG_QUIET);
-                moveCount++;
-            }
-        }
-    }
-}
-
-void generate_rook_moves_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-    const int them = whiteToMove ? BLACK : WHITE;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[them];
-    Bitboard rooks = board.piece[ROOK - 1] & own;
-    Bitboard occ = board_occupancy(board);
+        Bitboard attacks;
+        if (type == KNIGHT) attacks = knight_attacks[from];
+        else if (type == BISHOP) attacks = get_bishop_attacks(from, info.occ);
+        else if (type == ROOK) attacks = get_rook_attacks(from, info.occ);
+        else attacks = get_bishop_attacks(from, info.occ) | get_rook_attacks(from, info.occ);
 
-    while (rooks) {
-        int from = lsb(rooks);
-        rooks &= rooks - 1;
-
-        Bitboard targets = get_rook_attacks(from, occ) & ~own;
-        while (targets) {
-            int to = lsb(targets);
-            targets &= targets - 1;
-            
-            bool isCapture = (opp & (1ULL << to)) != 0;
-            if (isCapture) {
-                int captured = piece_on_square_bb(board, to);
-                if (is_king_piece(captured)) continue;
-                push_move(moves + moveCount, from, to, FLAG_CAPTURE);
-                moveCount++;
-            } else {
-                push_move(moves + moveCount, from, to, FLAG_QUIET);
-                moveCount++;
-            }
+        attacks &= targets & pin_mask(info, from);
+        while (attacks) {
+            int to = lsb(attacks);
+            attacks &= attacks - 1;
+            const bool isCapture = (info.opp & (1ULL << to)) != 0;
+            push_move(moves + moveCount, from, to, isCapture ? FLAG_CAPTURE : FLAG_QUIET);
+            moveCount++;
         }
     }
 }
 
-void generate_queen_moves_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-    const int them = whiteToMove ? BLACK : WHITE;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[them];
-    Bitboard queens = board.piece[QUEEN - 1] & own;
-    Bitboard occ = board_occupancy(board);
+void generate_king_moves_bb(const Board& board, const MoveGenInfo& info, Move* moves, int& moveCount, GenType gen) {
+    const int from = info.kingSq;
+    const Bitboard targets = gen_targets(board, info, gen) & ~info.kingDanger;
 
-    while (queens) {
-        int from = lsb(queens);
-        queens &= queens - 1;
-
-        Bitboard targets = (get_bishop_attacks(from, occ) | get_rook_attacks(from, occ)) & ~own;
-        while (targets) {
-            int to = lsb(targets);
-            targets &= targets - 1;
-            
-            bool isCapture = (opp & (1ULL << to)) != 0;
-            if (isCapture) {
-                int captured = piece_on_square_bb(board, to);
-                if (is_king_piece(captured)) continue;
-                push_move(moves + moveCount, from, to, FLAG_CAPTURE);
-                moveCount++;
-            } else {
-                push_move(moves + moveCount, from, to, FLAG_QUIET);
-                moveCount++;
-            }
-        }
+    Bitboard attacks = king_attacks[from] & targets;
+    while (attacks) {
+        int to = lsb(attacks);
+        attacks &= attacks - 1;
+        const bool isCapture = (info.opp & (1ULL << to)) != 0;
+        push_move(moves + moveCount, from, to, isCapture ? FLAG_CAPTURE : FLAG_QUIET);
+        moveCount++;
     }
-}
-
-void generate_king_moves_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-    const int them = whiteToMove ? BLACK : WHITE;
 
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[them];
-    Bitboard kings = board.piece[KING - 1] & own;
-    if (!kings) return;
+    if (gen == GEN_CAPTURES || info.checkers) return;
 
-    int from = lsb(kings);
+    // Any attack along the back rank would go through the king and be a check, so the danger
+    // squares computed with the king lifted are exact here.
+    const Bitboard occ = info.occ;
+    const Bitboard danger = info.kingDanger;
+    const Bitboard rooks = board.piece[ROOK - 1] & info.own;
 
-    Bitboard targets = king_attacks[from] & ~own;
-    while (targets) {
-        int to = lsb(targets);
-        targets &= targets - 1;
-        
-        bool isCapture = (opp & (1ULL << to)) != 0;
-        if (isCapture) {
-            int captured = piece_on_square_bb(board, to);
-            if (is_king_piece(captured)) continue;
-            push_move(moves + moveCount, from, to, FLAG_CAPTURE);
+    if (info.us == WHITE && from == 4) {
+        if ((board.castling & CASTLE_WK) && (rooks & (1ULL << 7)) &&
+            !(occ & ((1ULL << 5) | (1ULL << 6))) && !(danger & ((1ULL << 5) | (1ULL << 6)))) {
+            push_move(moves + moveCount, 4, 6, FLAG_CASTLE_KING);
             moveCount++;
-        } else {
-            push_move(moves + moveCount, from, to, FLAG_QUIET);
+        }
+        if ((board.castling & CASTLE_WQ) && (rooks & (1ULL << 0)) &&
+            !(occ & ((1ULL << 1) | (1ULL << 2) | (1ULL << 3))) && !(danger & ((1ULL << 2) | (1ULL << 3)))) {
+            push_move(moves + moveCount, 4, 2, FLAG_CASTLE_QUEEN);
             moveCount++;
         }
     }
 
-    Bitboard occ = board_occupancy(board);
-    const bool opponentIsWhite = !whiteToMove;
-
-    if (whiteToMove && from == 4) {
-        if (board.castling & CASTLE_WK) {
-            const Bitboard emptyMask = (1ULL << 5) | (1ULL << 6);
-            const bool rookPresent = (board.piece[ROOK - 1] & board.color[WHITE]) & (1ULL << 7);
-            if ((occ & emptyMask) == 0 &&
-                !is_square_attacked_bb(board, 4, opponentIsWhite) &&
-                !is_square_attacked_bb(board, 5, opponentIsWhite) &&
-                !is_square_attacked_bb(board, 6, opponentIsWhite) &&
-                rookPresent) {
-                push_move(moves + moveCount, 4, 6, FLAG_CASTLE_KING);
-                moveCount++;
-            }
+    if (info.us == BLACK && from == 60) {
+        if ((board.castling & CASTLE_BK) && (rooks & (1ULL << 63)) &&
+            !(occ & ((1ULL << 61) | (1ULL << 62))) && !(danger & ((1ULL << 61) | (1ULL << 62)))) {
+            push_move(moves + moveCount, 60, 62, FLAG_CASTLE_KING);
+            moveCount++;
         }
-        if (board.castling & CASTLE_WQ) {
-            const Bitboard emptyMask = (1ULL << 1) | (1ULL << 2) | (1ULL << 3);
-            const bool rookPresent = (board.piece[ROOK - 1] & board.color[WHITE]) & (1ULL << 0);
-            if ((occ & emptyMask) == 0 &&
-                !is_square_attacked_bb(board, 4, opponentIsWhite) &&
-                !is_square_attacked_bb(board, 3, opponentIsWhite) &&
-                !is_square_attacked_bb(board, 2, opponentIsWhite) &&
-                rookPresent) {
-                push_move(moves + moveCount, 4, 2, FLAG_CASTLE_QUEEN);
-                moveCount++;
-            }
+        if ((board.castling & CASTLE_BQ) && (rooks & (1ULL << 56)) &&
+            !(occ & ((1ULL << 57) | (1ULL << 58) | (1ULL << 59))) && !(danger & ((1ULL << 58) | (1ULL << 59)))) {
+            push_move(moves + moveCount, 60, 58, FLAG_CASTLE_QUEEN);
+            moveCount++;
         }
     }
+}
 
-    if (!whiteToMove && from == 60) {
-        if (board.castling & CASTLE_BK) {
-            const Bitboard emptyMask = (1ULL << 61) | (1ULL << 62);
-            const bool rookPresent = (board.piece[ROOK - 1] & board.color[BLACK]) & (1ULL << 63);
-            if ((occ & emptyMask) == 0 &&
-                !is_square_attacked_bb(board, 60, opponentIsWhite) &&
-                !is_square_attacked_bb(board, 61, opponentIsWhite) &&
-                !is_square_attacked_bb(board, 62, opponentIsWhite) &&
-                rookPresent) {
-                push_move(moves + moveCount, 60, 62, FLAG_CASTLE_KING);
-                moveCount++;
-            }
-        }
-        if (board.castling & CASTLE_BQ) {
-            const Bitboard emptyMask = (1ULL << 57) | (1ULL << 58) | (1ULL << 59);
-            const bool rookPresent = (board.piece[ROOK - 1] & board.color[BLACK]) & (1ULL << 56);
-            if ((occ & emptyMask) == 0 &&
-                !is_square_attacked_bb(board, 60, opponentIsWhite) &&
-                !is_square_attacked_bb(board, 59, opponentIsWhite) &&
-                !is_square_attacked_bb(board, 58, opponentIsWhite) &&
-                rookPresent) {
-                push_move(moves + moveCount, 60, 58, FLAG_CASTLE_QUEEN);
-                moveCount++;
-            }
+// Pawn moves onto `to`, with all four promotions on the last rank.
+inline void push_pawn_move(Move* moves, int& moveCount, int from, int to, bool isCapture, int flag) {
+    if (to >= 56 || to <= 7) {
+        for (int promo : {QUEEN, ROOK, BISHOP, KNIGHT}) {
+            push_move(moves + moveCount, from, to, get_promo_flag(promo, isCapture));
+            moveCount++;
         }
+    } else {
+        push_move(moves + moveCount, from, to, flag);
+        moveCount++;
     }
 }
 
-void generate_pawn_captures_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[whiteToMove ? BLACK : WHITE];
-    Bitboard pawns = board.piece[PAWN - 1] & own;
-
-    while (pawns) {
-        int from = lsb(pawns);
-        pawns &= pawns - 1;
-
-        // Pawn captures (diagonal)
-        Bitboard attacks = pawn_attacks[us][from] & opp;
-        while (attacks) {
-            int capSq = lsb(attacks);
-            attacks &= attacks - 1;
-            int captured = piece_on_square_bb(board, capSq);
-            if (is_king_piece(captured)) continue;
+// Works from the answers instead of the pieces: the king steps away, or, against a single checker,
+// something captures it or blocks the ray. Only the few checkMask squares are looked at, and
+// pinned pieces never can do either.
+void generate_evasions_bb(const Board& board, const MoveGenInfo& info, Move* moves, int& moveCount) {
+    generate_king_moves_bb(board, info, moves, moveCount, GEN_ALL); // no castling out of check
+    if (info.checkers & (info.checkers - 1)) return;
+
+    const int checkerSq = lsb(info.checkers);
+    const Bitboard free = info.own & ~info.pinned;
+    const Bitboard pawns = board.piece[PAWN - 1] & free;
+    const Bitboard diagonal = (board.piece[BISHOP - 1] | board.piece[QUEEN - 1]) & free;
+    const Bitboard straight = (board.piece[ROOK - 1] | board.piece[QUEEN - 1]) & free;
+    const Bitboard knights = board.piece[KNIGHT - 1] & free;
+    const int up = info.us == WHITE ? 8 : -8;
+
+    Bitboard targets = info.checkMask;
+    while (targets) {
+        const int to = lsb(targets);
+        targets &= targets - 1;
+        const bool isCapture = to == checkerSq;
 
-            bool isPromo = whiteToMove ? (capSq >= 56) : (capSq <= 7);
-            if (isPromo) {
-                for (int promo : {QUEEN, ROOK, BISHOP, KNIGHT}) {
-                    push_move(moves + moveCount, from, capSq, get_promo_flag(promo, true));
-                    moveCount++;
-                }
-            } else {
-                push_move(moves + moveCount, from, capSq, FLAG_CAPTURE);
-                moveCount++;
+        if (isCapture) {
+            Bitboard attackers = pawn_attacks[info.them][to] & pawns;
+            while (attackers) {
+                push_pawn_move(moves, moveCount, lsb(attackers), to, true, FLAG_CAPTURE);
+                attackers &= attackers - 1;
             }
-        }
-
-        // En passant
-        if (board.enPassant != -1) {
-            int epRow = whiteToMove ? 2 : 5;
-            int epSq = row_col_to_sq(epRow, board.enPassant);
-            if (pawn_attacks[us][from] & (1ULL << epSq)) {
-                push_move(moves + moveCount, from, epSq, FLAG_EN_PASSANT);
+        } else {
+            // Blocking squares are empty, so a pawn behind one can push onto it
+            const int from = to - up;
+            if (from >= 0 && from < 64 && (pawns & (1ULL << from))) {
+                push_pawn_move(moves, moveCount, from, to, false, FLAG_QUIET);
+            }
+            const int rank = to / 8;
+            const int from2 = to - 2 * up;
+            if ((info.us == WHITE ? rank == 3 : rank == 4) && (pawns & (1ULL << from2)) && !(info.occ & (1ULL << from))) {
+                push_move(moves + moveCount, from2, to, FLAG_DOUBLE_PAWN);
                 moveCount++;
             }
         }
-    }
-}
-
-void generate_knight_captures_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[whiteToMove ? BLACK : WHITE];
-    Bitboard knights = board.piece[KNIGHT - 1] & own;
-
-    while (knights) {
-        int from = lsb(knights);
-        knights &= knights - 1;
-
-        Bitboard targets = knight_attacks[from] & opp; // only opponent squares
-        while (targets) {
-            int to = lsb(targets);
-            targets &= targets - 1;
-            int captured = piece_on_square_bb(board, to);
-            if (is_king_piece(captured)) continue;
-            push_move(moves + moveCount, from, to, FLAG_CAPTURE);
-            moveCount++;
-        }
-    }
-}
-
-void generate_bishop_captures_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[whiteToMove ? BLACK : WHITE];
-    Bitboard bishops = board.piece[BISHOP - 1] & own;
-    Bitboard occ = board_occupancy(board);
 
-    while (bishops) {
-        int from = lsb(bishops);
-        bishops &= bishops - 1;
-
-        Bitboard targets = get_bishop_attacks(from, occ) & opp; // only opponent squares
-        while (targets) {
-            int to = lsb(targets);
-            targets &= targets - 1;
-            int captured = piece_on_square_bb(board, to);
-            if (is_king_piece(captured)) continue;
-            push_move(moves + moveCount, from, to, FLAG_CAPTURE);
+        Bitboard attackers = (knight_attacks[to] & knights)
+                           | (get_bishop_attacks(to, info.occ) & diagonal)
+                           | (get_rook_attacks(to, info.occ) & straight);
+        while (attackers) {
+            push_move(moves + moveCount, lsb(attackers), to, isCapture ? FLAG_CAPTURE : FLAG_QUIET);
             moveCount++;
+            attackers &= attackers - 1;
         }
     }
-}
-
-void generate_rook_captures_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[whiteToMove ? BLACK : WHITE];
-    Bitboard rooks = board.piece[ROOK - 1] & own;
-    Bitboard occ = board_occupancy(board);
 
-    while (rooks) {
-        int from = lsb(rooks);
-        rooks &= rooks - 1;
-
-        Bitboard targets = get_rook_attacks(from, occ) & opp;
-        while (targets) {
-            int to = lsb(targets);
-            targets &= targets - 1;
-            int captured = piece_on_square_bb(board, to);
-            if (is_king_piece(captured)) continue;
-            push_move(moves + moveCount, from, to, FLAG_CAPTURE);
-            moveCount++;
+    // En passant can only answer the check by removing the pawn that just gave it, the
+    // occupancy test covers that and the pins
+    if (board.enPassant != -1) {
+        const int epSq = row_col_to_sq(info.us == WHITE ? 2 : 5, board.enPassant);
+        Bitboard attackers = pawn_attacks[info.them][epSq] & board.piece[PAWN - 1] & info.own;
+        while (attackers) {
+            const int from = lsb(attackers);
+            attackers &= attackers - 1;
+            if (en_passant_legal(board, info, from, epSq)) {
+                push_move(moves + moveCount, from, epSq, FLAG_EN_PASSANT);
+                moveCount++;
+            }
         }
     }
 }
 
-void generate_queen_captures_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[whiteToMove ? BLACK : WHITE];
-    Bitboard queens = board.piece[QUEEN - 1] & own;
-    Bitboard occ = board_occupancy(board);
-
-    while (queens) {
-        int from = lsb(queens);
-        queens &= queens - 1;
-
-        Bitboard targets = (get_bishop_attacks(from, occ) | get_rook_attacks(from, occ)) & opp;
-        while (targets) {
-            int to = lsb(targets);
-            targets &= targets - 1;
-            int captured = piece_on_square_bb(board, to);
-            if (is_king_piece(captured)) continue;
-            push_move(moves + moveCount, from, to, FLAG_CAPTURE);
-            moveCount++;
+// Shared by the entry points below. Moves come out legal and in the order the old pseudo-legal
+// generator produced them: pawns, knights, bishops, rooks, queens, king.
+void generate_legal_moves(const Board& board, const MoveGenInfo& info, Move* moves, int& moveCount, GenType gen) {
+    // In double check only the king may move
+    if (!(info.checkers & (info.checkers - 1))) {
+        const Bitboard targets = gen_targets(board, info, gen) & info.checkMask;
+        generate_pawn_moves_bb(board, info, moves, moveCount, gen);
+        for (int type : {KNIGHT, BISHOP, ROOK, QUEEN}) {
+            generate_piece_moves_bb(board, info, type, targets, moves, moveCount);
         }
     }
-}
-
-void generate_king_captures_bb(const Board& board, Move* moves, int& moveCount) {
-    const bool whiteToMove = board.stm == WHITE;
-    const int us = whiteToMove ? WHITE : BLACK;
-
-    Bitboard own = board.color[us];
-    Bitboard opp = board.color[whiteToMove ? BLACK : WHITE];
-    Bitboard kings = board.piece[KING - 1] & own;
-    if (!kings) return;
-
-    int from = lsb(kings);
-
-    Bitboard targets = king_attacks[from] & opp; // only opponent squares
-    while (targets) {
-        int to = lsb(targets);
-        targets &= targets - 1;
-        int captured = piece_on_square_bb(board, to);
-        if (is_king_piece(captured)) continue;
-        push_move(moves + moveCount, from, to, FLAG_CAPTURE);
-        moveCount++;
-    }
+    generate_king_moves_bb(board, info, moves, moveCount, gen);
 }
 
 bool is_square_attacked(const Board& board, int sq, bool isWhiteAttacker) {
     return is_square_attacked_bb(board, sq, isWhiteAttacker);
 }
 
+// Positions in check go to the evasion generator, the analysis already knows the checkers.
 void get_all_moves(Board& board, Move moves[], int& moveCount) {
-    Move pseudoMoves[256];
-    int pseudoMoveCount = 0;
-    Move legalMoves[256];
-    int legalMoveCount = 0;
-
-    const bool sideToMove = board.stm == WHITE;
-
-    generate_pawn_moves_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_knight_moves_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_bishop_moves_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_rook_moves_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_queen_moves_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_king_moves_bb(board, pseudoMoves, pseudoMoveCount);
-
-    for (int i = 0; i < pseudoMoveCount; i++) {
-        Move m = pseudoMoves[i];
-        board.makeMove(m);
-        int kingSq = -1;
-        // After makeMove(), stm has already switched to the opponent.
-        // We must validate checks against the side that just moved.
-        king_square(board, sideToMove, kingSq);
-        if (kingSq == -1){
-            board.unmakeMove(m);
-            continue;
-        }
-
-        // The only illegal case is: our own king is attacked by the opponent.
-        if (!is_square_attacked(board, kingSq, board.stm == WHITE)) {
-            legalMoves[legalMoveCount++] = m;
-        }
-        board.unmakeMove(m);
-    }
-    int i = 0;
-    for (int j = 0; j < legalMoveCount; j++) {
-        moves[i++] = legalMoves[j];
+    moveCount = 0;
+    const MoveGenInfo info = analyse_position(board);
+    if (info.kingSq == -1) return;
+    if (info.checkers) {
+        generate_evasions_bb(board, info, moves, moveCount);
+        return;
     }
-    moveCount = i;
+    generate_legal_moves(board, info, moves, moveCount, GEN_ALL);
 }
 
 void get_capture_moves(Board& board, Move moves[], int& moveCount) {
-    Move pseudoMoves[256];
-    int pseudoMoveCount = 0;
-
-    generate_pawn_captures_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_knight_captures_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_bishop_captures_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_rook_captures_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_queen_captures_bb(board, pseudoMoves, pseudoMoveCount);
-    generate_king_captures_bb(board, pseudoMoves, pseudoMoveCount);
+    moveCount = 0;
+    const MoveGenInfo info = analyse_position(board);
+    if (info.kingSq != -1) generate_legal_moves(board, info, moves, moveCount, GEN_CAPTURES);
+}
 
-    const bool sideToMove = board.stm == WHITE;
+void get_quiet_moves(Board& board, Move moves[], int& moveCount) {
     moveCount = 0;
+    const MoveGenInfo info = analyse_position(board);
+    if (info.kingSq != -1) generate_legal_moves(board, info, moves, moveCount, GEN_QUIETS);
+}
 
-    for (int i = 0; i < pseudoMoveCount; i++) {
-        Move m = pseudoMoves[i];
-        board.makeMove(m);
-        int kingSq = -1;
-        king_square(board, sideToMove, kingSq);
-        if (kingSq == -1) {
-            board.unmakeMove(m);
-            continue;
-        }
-        if (!is_square_attacked(board, kingSq, board.stm == WHITE)) {
-            moves[moveCount++] = m;
-        }
-        board.unmakeMove(m);
+// Only generates for the moving piece's type and looks the move up, so a TT move or killer can
+// be played before the full list exists. Rejects anything the generator wouldn't produce here.
+bool is_legal_move(const Board& board, Move move) {
+    const int from = move_from(move);
+    const int to = move_to(move);
+    const int piece = board.mailbox[from];
+    if (move == 0 || piece == 0 || piece_color(piece) != board.stm) return false;
+
+    const MoveGenInfo info = analyse_position(board);
+    if (info.kingSq == -1) return false;
+
+    const int type = piece_type(piece);
+    const bool doubleCheck = (info.checkers & (info.checkers - 1)) != 0;
+    if (type != KING && doubleCheck) return false;
+
+    const GenType gen = is_capture(move) ? GEN_CAPTURES : GEN_QUIETS;
+    Move moves[256];
+    int moveCount = 0;
+    if (type == PAWN) {
+        generate_pawn_moves_bb(board, info, moves, moveCount, gen);
+    } else if (type == KING) {
+        generate_king_moves_bb(board, info, moves, moveCount, gen);
+    } else {
+        const Bitboard targets = gen_targets(board, info, gen) & info.checkMask & (1ULL << to);
+        generate_piece_moves_bb(board, info, type, targets, moves, moveCount);
     }
+    for (int i = 0; i < moveCount; i++) {
+        if (moves[i] == move) return true;
+    }
+    return false;
 }
@@ -19,6 +19,8 @@ alignas(64) int16_t hiddenBias[HIDDEN_SIZE];
 alignas(64) int16_t outputWeight[HIDDEN_SIZE * 2]; 
 int16_t outputBias;
 
+thread_local NNUEWeights nnueWeights = {hiddenWeight, hiddenBias, outputWeight};
+
 
 
 // Optimization additions. 
@@ -41,13 +43,14 @@ void applyQuietBoth(Accumulator* __restrict__ acc,
     int wAdd, int wSub,
     int bAdd, int bSub)
 {
+    const int16_t* __restrict__ weights = nnueWeights.hiddenWeight;
     const int addOffW = wAdd * HIDDEN_SIZE;
     const int subOffW = wSub * HIDDEN_SIZE;
     const int addOffB = bAdd * HIDDEN_SIZE;
     const int subOffB = bSub * HIDDEN_SIZE;
     for (int i = 0; i < HIDDEN_SIZE; i++) {
-        acc[0][i] += hiddenWeight[addOffW + i] - hiddenWeight[subOffW + i];
-        acc[1][i] += hiddenWeight[addOffB + i] - hiddenWeight[subOffB + i];
+        acc[0][i] += weights[addOffW + i] - weights[subOffW + i];
+        acc[1][i] += weights[addOffB + i] - weights[subOffB + i];
     }
 }
 
@@ -57,6 +60,7 @@ void applyCaptureBoth(Accumulator* __restrict__ acc,
     int wAdd, int wSub1, int wSub2,
     int bAdd, int bSub1, int bSub2)
 {
+    const int16_t* __restrict__ weights = nnueWeights.hiddenWeight;
     const int addOffW  = wAdd  * HIDDEN_SIZE;
     const int sub1OffW = wSub1 * HIDDEN_SIZE;
     const int sub2OffW = wSub2 * HIDDEN_SIZE;
@@ -64,8 +68,8 @@ void applyCaptureBoth(Accumulator* __restrict__ acc,
     const int sub1OffB = bSub1 * HIDDEN_SIZE;
     const int sub2OffB = bSub2 * HIDDEN_SIZE;
     for (int i = 0; i < HIDDEN_SIZE; i++) {
-        acc[0][i] += hiddenWeight[addOffW + i] - hiddenWeight[sub1OffW + i] - hiddenWeight[sub2OffW + i];
-        acc[1][i] += hiddenWeight[addOffB + i] - hiddenWeight[sub1OffB + i] - hiddenWeight[sub2OffB + i];
+        acc[0][i] += weights[addOffW + i] - weights[sub1OffW + i] - weights[sub2OffW + i];
+        acc[1][i] += weights[addOffB + i] - weights[sub1OffB + i] - weights[sub2OffB + i];
     }
 }
 
@@ -75,6 +79,7 @@ void applyCastlingBoth(Accumulator* __restrict__ acc,
     int wAdd1, int wAdd2, int wSub1, int wSub2,
     int bAdd1, int bAdd2, int bSub1, int bSub2)
 {
+    const int16_t* __restrict__ weights = nnueWeights.hiddenWeight;
     const int add1OffW = wAdd1 * HIDDEN_SIZE;
     const int add2OffW = wAdd2 * HIDDEN_SIZE;
     const int sub1OffW = wSub1 * HIDDEN_SIZE;
@@ -84,24 +89,25 @@ void applyCastlingBoth(Accumulator* __restrict__ acc,
     const int sub1OffB = bSub1 * HIDDEN_SIZE;
     const int sub2OffB = bSub2 * HIDDEN_SIZE;
     for (int i = 0; i < HIDDEN_SIZE; i++) {
-        acc[0][i] += hiddenWeight[add1OffW + i] + hiddenWeight[add2OffW + i]
-                   - hiddenWeight[sub1OffW + i] - hiddenWeight[sub2OffW + i];
-        acc[1][i] += hiddenWeight[add1OffB + i] + hiddenWeight[add2OffB + i]
-                   - hiddenWeight[sub1OffB + i] - hiddenWeight[sub2OffB + i];
+        acc[0][i] += weights[add1OffW + i] + weights[add2OffW + i]
+                   - weights[sub1OffW + i] - weights[sub2OffW + i];
+        acc[1][i] += weights[add1OffB + i] + weights[add2OffB + i]
+                   - weights[sub1OffB + i] - weights[sub2OffB + i];
     }
 }
 
 // Legacy single accumulator update (kept for RefreshAccumulator)
 void updateAccumulator(Accumulator& acc, int featureIdx, bool isAdd) { 
+    const int16_t* __restrict__ weights = nnueWeights.hiddenWeight;
     int offset = featureIdx * HIDDEN_SIZE;
     
     if (isAdd) {
         for (int i = 0; i < HIDDEN_SIZE; i++) {
-            acc[i] += hiddenWeight[offset + i];
+            acc[i] += weights[offset + i];
         }
     } else {
         for (int i = 0; i < HIDDEN_SIZE; i++) {
-            acc[i] -= hiddenWeight[offset + i];
+            acc[i] -= weights[offset + i];
         }
     }
 }
@@ -134,9 +140,10 @@ void load_nnue() {
 }
 
 void RefreshAccumulator(const Board& board, Accumulator* acc_white, Accumulator* acc_black) {
+    const int16_t* bias = nnueWeights.hiddenBias;
     for (int i = 0; i < HIDDEN_SIZE; i++) {
-        (*acc_white)[i] = hiddenBias[i];
-        (*acc_black)[i] = hiddenBias[i];
+        (*acc_white)[i] = bias[i];
+        (*acc_black)[i] = bias[i];
     }
 
     for (int sq = 0; sq < 64; sq++) {
@@ -159,15 +166,16 @@ int evaluate_nnue(const Accumulator& acc_white, const Accumulator& acc_black, in
     const Accumulator& us = (side_to_move == WHITE) ? acc_white : acc_black;
     const Accumulator& them = (side_to_move == WHITE) ? acc_black : acc_white;
 
+    const int16_t* outWeights = nnueWeights.outputWeight;
     int32_t raw_sum = 0; 
 
     for (int i = 0; i < HIDDEN_SIZE; i++) {
         int16_t v_us = std::clamp(us[i], (int16_t)0, (int16_t)255);
-        int16_t vw_us = v_us * outputWeight[i];
+        int16_t vw_us = v_us * outWeights[i];
         raw_sum += v_us * vw_us;
 
         int16_t v_them = std::clamp(them[i], (int16_t)0, (int16_t)255);
-        int16_t vw_them = v_them * outputWeight[HIDDEN_SIZE + i];
+        int16_t vw_them = v_them * outWeights[HIDDEN_SIZE + i];
         raw_sum += v_them * vw_them;
     }
 
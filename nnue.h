@@ -19,6 +19,15 @@ extern int16_t hiddenBias[NNUE_HIDDEN_SIZE];
 extern int16_t outputWeight[NNUE_HIDDEN_SIZE * 2];
 extern int16_t outputBias;
 
+// Weights read by the hot NNUE routines. Points at the arrays above unless the thread is
+// NUMA bound, then it points at a copy on the thread's own node (see numa.cpp).
+struct NNUEWeights {
+    const int16_t* hiddenWeight;
+    const int16_t* hiddenBias;
+    const int16_t* outputWeight;
+};
+extern thread_local NNUEWeights nnueWeights;
+
 
 void updateAccumulator(Accumulator& acc, int featureIdx, bool isAdd);
 int makeFeatureIndex(int piece_type, int piece_color, int square, int perspective);
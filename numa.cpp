@@ -0,0 +1,139 @@
+#include "numa.h"
+#include "nnue.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool numaOn = false;
+
+// Per-node copies of the NNUE weights, created by the first thread bound to that node
+// so first-touch places the pages locally.
+struct NodeWeights {
+    std::unique_ptr<int16_t[]> hiddenWeight;
+    std::unique_ptr<int16_t[]> hiddenBias;
+    std::unique_ptr<int16_t[]> outputWeight;
+};
+std::vector<NodeWeights> nodeWeights;
+std::mutex nodeWeightsMutex;
+
+// Parses a sysfs cpulist such as "0-7,16-23"
+std::vector<int> parse_cpulist(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) continue;
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+};
+
+// Every node that has CPUs attached, sorted by node id
+const std::vector<NumaNode>& topology() {
+    static const std::vector<NumaNode> nodes = []() {
+        std::vector<NumaNode> found;
+#ifdef __linux__
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.rfind("node", 0) != 0 || name.size() <= 4) continue;
+            if (!std::all_of(name.begin() + 4, name.end(), [](unsigned char c) { return std::isdigit(c); })) continue;
+
+            std::ifstream file(entry.path() / "cpulist");
+            std::string list;
+            if (!std::getline(file, list)) continue;
+            std::vector<int> cpus = parse_cpulist(list);
+            if (!cpus.empty()) found.push_back({std::stoi(name.substr(4)), cpus});
+        }
+#endif
+        std::sort(found.begin(), found.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+        return found;
+    }();
+    return nodes;
+}
+
+void use_node_weights(int node) {
+    std::lock_guard<std::mutex> lock(nodeWeightsMutex);
+    if (nodeWeights.size() < topology().size()) nodeWeights.resize(topology().size());
+
+    NodeWeights& w = nodeWeights[node];
+    if (!w.hiddenWeight) {
+        w.hiddenWeight = std::make_unique<int16_t[]>(NNUE_INPUT_SIZE * NNUE_HIDDEN_SIZE);
+        w.hiddenBias = std::make_unique<int16_t[]>(NNUE_HIDDEN_SIZE);
+        w.outputWeight = std::make_unique<int16_t[]>(NNUE_HIDDEN_SIZE * 2);
+        std::memcpy(w.hiddenWeight.get(), hiddenWeight, sizeof(hiddenWeight));
+        std::memcpy(w.hiddenBias.get(), hiddenBias, sizeof(hiddenBias));
+        std::memcpy(w.outputWeight.get(), outputWeight, sizeof(outputWeight));
+    }
+    nnueWeights = {w.hiddenWeight.get(), w.hiddenBias.get(), w.outputWeight.get()};
+}
+
+} // namespace
+
+int numa_node_count() {
+    return std::max<int>(1, static_cast<int>(topology().size()));
+}
+
+void numa_set_enabled(bool enabled) {
+    numaOn = enabled;
+}
+
+bool numa_enabled() {
+    return numaOn && numa_node_count() > 1;
+}
+
+void numa_bind_thread(int index) {
+    if (!numa_enabled()) return;
+    const int node = index % numa_node_count();
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : topology()[node].cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+
+    use_node_weights(node);
+}
+
+void numa_interleave(void* addr, size_t bytes) {
+    if (!numa_enabled()) return;
+#if defined(__linux__) && defined(SYS_mbind)
+    constexpr int MPOL_INTERLEAVE_MODE = 3; // MPOL_INTERLEAVE from <linux/mempolicy.h>
+    unsigned long nodemask = 0;
+    for (const NumaNode& node : topology()) {
+        if (node.id < static_cast<int>(sizeof(nodemask) * 8)) nodemask |= 1UL << node.id;
+    }
+    syscall(SYS_mbind, addr, bytes, MPOL_INTERLEAVE_MODE, &nodemask, sizeof(nodemask) * 8, 0);
+#else
+    (void)addr;
+    (void)bytes;
+#endif
+}
@@ -0,0 +1,23 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <cstddef>
+
+// NUMA support without external libraries. The topology is read from /sys/devices/system/node,
+// on single-node machines (or anything that isn't Linux) every call below is a no-op.
+
+int numa_node_count();
+
+// When enabled, threads bound through numa_bind_thread() are pinned to the cores of one node
+// and read the NNUE weights from a copy that lives on that node.
+void numa_set_enabled(bool enabled);
+bool numa_enabled();
+
+// Pins the calling thread to node (index % nodes). index is the pool / datagen thread index.
+void numa_bind_thread(int index);
+
+// Spreads the pages of [addr, addr + bytes) round-robin over all nodes. Must be called before
+// the memory is touched for the first time, addr must be page aligned.
+void numa_interleave(void* addr, size_t bytes);
+
+#endif
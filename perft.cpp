@@ -0,0 +1,163 @@
+#include "perft.h"
+#include "uci.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace {
+
+// Subtree counts keyed by position hash and remaining depth. Same lock-free scheme as the search TT:
+// the key is stored XOR-ed with the count, so a torn write simply fails verification.
+struct PerftEntry {
+    std::atomic<uint64_t> keyXorNodes{0};
+    std::atomic<uint64_t> nodes{0};
+};
+
+class PerftTable {
+public:
+    explicit PerftTable(int mb) {
+        numEntries = std::max<size_t>(1, static_cast<size_t>(mb) * 1024 * 1024 / sizeof(PerftEntry));
+        table = std::make_unique<PerftEntry[]>(numEntries);
+    }
+
+    bool probe(uint64_t hash, int depth, uint64_t& nodes) const {
+        const uint64_t key = entry_key(hash, depth);
+        const PerftEntry& e = table[key % numEntries];
+        const uint64_t count = e.nodes.load(std::memory_order_relaxed);
+        if ((e.keyXorNodes.load(std::memory_order_relaxed) ^ count) != key) return false;
+        nodes = count;
+        return true;
+    }
+
+    void store(uint64_t hash, int depth, uint64_t nodes) {
+        const uint64_t key = entry_key(hash, depth);
+        PerftEntry& e = table[key % numEntries];
+        e.keyXorNodes.store(key ^ nodes, std::memory_order_relaxed);
+        e.nodes.store(nodes, std::memory_order_relaxed);
+    }
+
+private:
+    static uint64_t entry_key(uint64_t hash, int depth) {
+        return hash ^ (static_cast<uint64_t>(depth) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    std::unique_ptr<PerftEntry[]> table;
+    size_t numEntries = 0;
+};
+
+uint64_t perft_count(Board& board, int depth, PerftTable* table) {
+    if (depth <= 0) return 1ULL;
+
+    int moveCount = 0;
+    Move moves[256];
+    get_all_moves(board, moves, moveCount);
+    if (depth == 1) return static_cast<uint64_t>(moveCount); // the generator is fully legal
+
+    uint64_t nodes = 0;
+    if (table && table->probe(board.hash, depth, nodes)) return nodes;
+
+    for (int i = 0; i < moveCount; i++) {
+        board.makeMove(moves[i]);
+        nodes += perft_count(board, depth - 1, table);
+        board.unmakeMove(moves[i]);
+    }
+
+    if (table) table->store(board.hash, depth, nodes);
+    return nodes;
+}
+
+// One unit of parallel work: a root move and, below depth 2, one of its replies.
+struct PerftTask {
+    int rootIndex;
+    Move reply; // 0 = count the root move's whole subtree
+};
+
+} // namespace
+
+void run_perft(const Board& board, int depth, int threads, int hashMb) {
+    threads = std::clamp(threads, 1, threadPool.size());
+    std::unique_ptr<PerftTable> table;
+    if (hashMb > 0) table = std::make_unique<PerftTable>(hashMb);
+
+    Board root = board;
+    int rootCount = 0;
+    Move rootMoves[256];
+    get_all_moves(root, rootMoves, rootCount);
+
+    // Split on the second ply as well, the root alone has too few moves to balance 8+ threads.
+    std::vector<PerftTask> tasks;
+    for (int i = 0; i < rootCount; i++) {
+        if (depth < 3) {
+            tasks.push_back({i, 0});
+            continue;
+        }
+        root.makeMove(rootMoves[i]);
+        int replyCount = 0;
+        Move replies[256];
+        get_all_moves(root, replies, replyCount);
+        for (int j = 0; j < replyCount; j++) tasks.push_back({i, replies[j]});
+        root.unmakeMove(rootMoves[i]);
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> divide(new std::atomic<uint64_t>[std::max(1, rootCount)]);
+    for (int i = 0; i < rootCount; i++) divide[i].store(0, std::memory_order_relaxed);
+    std::atomic<size_t> nextTask{0};
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    auto worker = [&](Board& pos) {
+        size_t t;
+        while ((t = nextTask.fetch_add(1, std::memory_order_relaxed)) < tasks.size()) {
+            const PerftTask& task = tasks[t];
+            const Move rootMove = rootMoves[task.rootIndex];
+            uint64_t nodes;
+            pos.makeMove(rootMove);
+            if (task.reply) {
+                pos.makeMove(task.reply);
+                nodes = perft_count(pos, depth - 2, table.get());
+                pos.unmakeMove(task.reply);
+            } else {
+                nodes = perft_count(pos, depth - 1, table.get());
+            }
+            pos.unmakeMove(rootMove);
+            divide[task.rootIndex].fetch_add(nodes, std::memory_order_relaxed);
+        }
+    };
+
+    if (depth > 0) {
+        std::vector<std::unique_ptr<Board>> boards;
+        for (int i = 0; i < threads; i++) boards.push_back(std::make_unique<Board>(board));
+
+        // Pool threads 1..threads-1 help, the calling thread (pool thread 0) is the first worker
+        for (int i = 1; i < threads; i++) {
+            Board& pos = *boards[i];
+            threadPool[i].run([&worker, &pos]() { worker(pos); });
+        }
+        worker(*boards[0]);
+        for (int i = 1; i < threads; i++) threadPool[i].wait();
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+    long long elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+
+    uint64_t total = (depth > 0) ? 0 : 1;
+    for (int i = 0; i < rootCount && depth > 0; i++) {
+        const uint64_t nodes = divide[i].load(std::memory_order_relaxed);
+        std::cout << move_to_uci(rootMoves[i]) << ": " << nodes << std::endl;
+        total += nodes;
+    }
+
+    const double mnps = (elapsedUs > 0) ? static_cast<double>(total) / elapsedUs : 0.0;
+    std::cout << "perft " << depth << " nodes " << total
+              << " time " << elapsedUs / 1000 << "ms"
+              << " mnps " << mnps
+              << " threads " << threads
+              << " hash " << std::max(0, hashMb) << "MB"
+              << std::endl;
+}
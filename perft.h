@@ -0,0 +1,13 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "board.h"
+#include <cstdint>
+
+// `perft <depth> threads=N hash=MB`: splits the root and second-ply moves over `threads` workers,
+// each on its own board copy. Runs on pool thread 0 with pool threads 1..threads-1 as helpers, so
+// the pool must have at least `threads` threads (more are clamped). hashMb > 0 enables a shared
+// lock-free table of subtree counts. Prints the per-move (divide) counts, the total and Mnps.
+void run_perft(const Board& board, int depth, int threads, int hashMb);
+
+#endif
@@ -5,6 +5,7 @@
 #include "board.h"
 #include "history.h"
 #include "nnue.h"
+#include "threadpool.h"
 
 #include <atomic>
 #include <iostream>
@@ -18,43 +19,42 @@
 #define SEE_THRESHOLD -82
 
 namespace {
-// Global stop flag — set by UCI 'stop' command to interrupt all threads.
+// Stop flag of the UCI search, polled by all its threads. Raised by the UCI `stop` command, by
+// deadlineTimer at the hard time limit and by the main thread once it has finished.
 std::atomic<bool> stop_search_global{false};
 
-// Per-thread search state — no synchronisation needed, each thread is independent.
-thread_local bool      stop_search_local    = false;
-thread_local long long nodeCount            = 0;
-thread_local long long start_time_ms        = 0;
-thread_local long long soft_time_limit_ms   = 0;
-thread_local long long hard_time_limit_ms   = 0;
-thread_local long long soft_node_limit      = -1;
-thread_local bool      time_limited         = false;
-thread_local int       seldepth             = 0;
+// Number of threads used by the UCI search (main thread + helpers).
+int searchThreads = 1;
 
-inline void updateSeldepth(int ply) {
-    if (ply > seldepth) seldepth = ply;
-}
+SmpMode smpMode = SMP_LAZY;
 
-void resetSeldepth() {
-    seldepth = 0;
-}
+// Workers used by the UCI search, index 0 is the main thread. Kept alive across searches
+// so their history survives between moves, just like the old global tables did.
+std::vector<std::unique_ptr<SearchWorker>> searchWorkers;
 
-int getSeldepth() {
-    return seldepth;
-}
+// Table the pooled workers search with, ttTable unless setSearchTranspositionTable() redirected them.
+TranspositionTable* searchTable = &ttTable;
 
-int hash_full(void) {
-  int used = 0;
-  int samples = 1000;
+// Root board copies for the helpers, reused across searches to avoid reallocating accumulators.
+std::vector<std::unique_ptr<Board>> helperBoards;
 
-  for (int i = 0; i < samples; ++i) {
-    if (ttTable.getEntry(i).hashKey != 0) {
-      used++;
-    }
-  }
+// Node count of the last search run through getBestMove(), summed over all its threads.
+long long lastSearchNodes = 0;
 
-  return used;
-}
+// TT tier counters of every getBestMove() search since resetTTTierStats().
+TTTierStats tierTotals[TT_TIER_NB];
+
+// `go nodes` limit for the next getBestMove() call, counted over all threads.
+long long searchNodeLimit = -1;
+
+// Instrumentation: when `go` was received, used to report the latency until the root search starts.
+bool logTiming = false;
+std::chrono::steady_clock::time_point goReceivedAt{};
+bool goPending = false;
+// Start and hard deadline of the last time-limited getBestMove() call, for the overshoot report.
+bool lastSearchTimed = false;
+DeadlineTimer::Clock::time_point lastSearchStart{};
+DeadlineTimer::Clock::time_point lastSearchDeadline{};
 
 const int PIECE_VALUES[7] = {0, 100, 320, 330, 500, 900, 20000};
 
@@ -63,64 +63,124 @@ inline long long now_ms() {
     return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
 }
 
-inline bool should_stop_search() {
-    if (stop_search_global.load(std::memory_order_relaxed)) return true;
-    if (stop_search_local) return true;
-    // Check soft node limit on every node (thread_local, no contention)
-    if (soft_node_limit > 0 && nodeCount >= soft_node_limit) {
-        stop_search_local = true;
-        return true;
+void ensureSearchWorkers(int count) {
+    while (static_cast<int>(searchWorkers.size()) < count) {
+        searchWorkers.push_back(std::make_unique<SearchWorker>(static_cast<int>(searchWorkers.size())));
+        searchWorkers.back()->setTranspositionTable(searchTable);
     }
-    if (!time_limited) return false;
-    if ((nodeCount & 2047) == 0) {
-        long long elapsed = now_ms() - start_time_ms;
-        if (elapsed >= hard_time_limit_ms) {
-            stop_search_local = true;
-            return true;
-        }
+}
+
+// ABDADA: (position, move) pairs that some thread is currently searching. A thread marks a move
+// before searching it and clears the mark afterwards; the other threads defer marked moves to the
+// end of their move list. This lives beside the TT rather than in it: TT entries are two
+// XOR-checked atomic words, and a busy counter does not fit that scheme.
+constexpr int ABDADA_BUCKETS = 32768; // power of two
+constexpr int ABDADA_WAYS = 4;
+constexpr int ABDADA_MIN_DEPTH = 3;   // shallower nodes are cheaper to search twice than to coordinate
+std::atomic<uint64_t> abdadaTable[ABDADA_BUCKETS][ABDADA_WAYS];
+
+inline uint64_t abdada_key(uint64_t hash, Move move) {
+    uint64_t key = hash ^ (static_cast<uint64_t>(move) * 0x9E3779B97F4A7C15ULL);
+    return key ? key : 1; // 0 marks an empty slot
+}
+
+inline std::atomic<uint64_t>* abdada_bucket(uint64_t key) {
+    return abdadaTable[key & (ABDADA_BUCKETS - 1)];
+}
+
+bool abdada_busy(uint64_t key) {
+    std::atomic<uint64_t>* bucket = abdada_bucket(key);
+    for (int i = 0; i < ABDADA_WAYS; ++i) {
+        if (bucket[i].load(std::memory_order_relaxed) == key) return true;
     }
     return false;
 }
 
-inline bool soft_limit_reached() {
-    if (!time_limited) return false;
-    long long elapsed = now_ms() - start_time_ms;
-    return elapsed >= soft_time_limit_ms;
+// Returns false if the bucket is full, the move is then searched without a mark.
+bool abdada_mark(uint64_t key) {
+    std::atomic<uint64_t>* bucket = abdada_bucket(key);
+    for (int i = 0; i < ABDADA_WAYS; ++i) {
+        uint64_t expected = 0;
+        if (bucket[i].compare_exchange_strong(expected, key, std::memory_order_relaxed)) return true;
+    }
+    return false;
 }
 
-inline bool soft_node_limit_reached() {
-    if (soft_node_limit <= 0) return false;
-    return nodeCount >= soft_node_limit;
+void abdada_unmark(uint64_t key) {
+    std::atomic<uint64_t>* bucket = abdada_bucket(key);
+    for (int i = 0; i < ABDADA_WAYS; ++i) {
+        uint64_t expected = key;
+        if (bucket[i].compare_exchange_strong(expected, 0, std::memory_order_relaxed)) return;
+    }
 }
 
 } // namespace
 
-void setSoftNodeLimit(long long nodes) {
-    soft_node_limit = nodes;
-}
+// One counter per search thread, each on its own cache line. Only the owning thread writes it
+// (a plain relaxed store every NODE_PUBLISH_INTERVAL nodes), so counting never contends.
+struct alignas(64) NodeCounter {
+    std::atomic<long long> nodes{0};
+};
 
-int LMR_TABLE[256][256];
-float LMR_BASE = 0.77f;
-float LMR_DIVISION = 2.32f;
+constexpr long long NODE_PUBLISH_INTERVAL = 1024;
 
-// Killer moves table: per-thread so datagen threads don't corrupt each other
-thread_local Move killerMoves[MAX_PLY][2];
+// Shared state between the main search thread and its helpers.
+struct SmpContext {
+    std::vector<NodeCounter> counters; // indexed by threadId
+    bool abdada;
 
-void clearKillers() {
-    for (int i = 0; i < MAX_PLY; i++) {
-        killerMoves[i][0] = 0;
-        killerMoves[i][1] = 0;
+    SmpContext(int threads, bool useAbdada) : counters(threads), abdada(useAbdada) {}
+
+    long long totalNodes() const {
+        long long total = 0;
+        for (const auto& c : counters) total += c.nodes.load(std::memory_order_relaxed);
+        return total;
     }
+};
+
+void setLogTiming(bool enabled) {
+    logTiming = enabled;
 }
 
-void updateKillers(int ply, Move move) {
-    if (ply >= MAX_PLY) return;
-    // Don't store duplicates
-    if (killerMoves[ply][0] == move) return;
-    killerMoves[ply][1] = killerMoves[ply][0];
-    killerMoves[ply][0] = move;
+void markGoReceived() {
+    goReceivedAt = std::chrono::steady_clock::now();
+    goPending = true;
+}
+
+void logBestmoveTiming() {
+    if (!logTiming || !lastSearchTimed) return;
+    const auto now = DeadlineTimer::Clock::now();
+    const auto limit = std::chrono::duration_cast<std::chrono::microseconds>(lastSearchDeadline - lastSearchStart);
+    const auto used = std::chrono::duration_cast<std::chrono::microseconds>(now - lastSearchStart);
+    std::cout << "info string time limit " << limit.count() << " us used " << used.count()
+              << " us overshoot " << (used - limit).count() << " us" << std::endl;
+}
+
+void setNodeLimit(long long nodes) {
+    searchNodeLimit = nodes;
 }
 
+void setSearchThreads(int threads) {
+    searchThreads = std::max(1, threads);
+    ensureSearchWorkers(searchThreads); // allocate up front, not on the first `go`
+}
+
+int getSearchThreads() {
+    return searchThreads;
+}
+
+void setSmpMode(SmpMode mode) {
+    smpMode = mode;
+}
+
+SmpMode getSmpMode() {
+    return smpMode;
+}
+
+int LMR_TABLE[256][256];
+float LMR_BASE = 0.77f;
+float LMR_DIVISION = 2.32f;
+
 void initLMRtables(){
     for(int depth = 0; depth < 256; depth++){
         for(int moveNum = 0; moveNum < 256; moveNum++){
@@ -134,83 +194,260 @@ void initLMRtables(){
 }
 
 void resetNodeCounter() {
-    nodeCount = 0;
+    lastSearchNodes = 0;
 }
 
 long long getNodeCounter() {
-    return nodeCount;
+    return lastSearchNodes;
+}
+
+void resetTTTierStats() {
+    for (TTTierStats& stats : tierTotals) stats = {};
+}
+
+TTTierStats getTTTierStats(TTTier tier) {
+    return tierTotals[tier];
 }
 
 void requestSearchStop() {
     stop_search_global.store(true, std::memory_order_relaxed);
 }
 
-int scoreMove(Board& board, const Move& move, Move ttMove = 0, int ply = 0) {
-    int score = 0;
-    int from = move_from(move);
-    int to = move_to(move);
-    int piece = piece_at_sq(board, from);
-    int flags = move_flags(move);
+void clearQSearchTables() {
+    for (auto& worker : searchWorkers) {
+        worker->clearQSearchTable();
+    }
+}
 
-    if (is_capture(move)) {
-        int victimPiece = flags == FLAG_EN_PASSANT ? PAWN : piece_type(board.mailbox[to]);
-        int victimValue = PIECE_VALUES[victimPiece];
+void setSearchTranspositionTable(TranspositionTable* table) {
+    searchTable = table ? table : &ttTable;
+    for (auto& worker : searchWorkers) {
+        worker->setTranspositionTable(searchTable);
+    }
+}
 
-        int attackerPiece = piece_at_sq(board, from);
-        int attackerValue = PIECE_VALUES[piece_type(attackerPiece)];
-        int mvvScore = victimValue * 10 - attackerValue;
+void clearSearchHistory() {
+    for (auto& worker : searchWorkers) {
+        worker->clearHistory();
+    }
+}
 
-        if (staticExchangeEvaluation(board, move, SEE_THRESHOLD)) {
-            mvvScore += SCORE_GOOD_CAPTURE;
-        } else {
-            mvvScore += SCORE_BAD_CAPTURE;
-        }
+SearchWorker::SearchWorker(int threadId) : threadId(threadId), tt(&ttTable), stopFlag(&ownStop) {
+    clearHistory();
+    history.reset_movestack();
+    clearKillers();
+}
+
+void SearchWorker::clearHistory() {
+    history.clear_history();
+}
+
+void SearchWorker::clearKillers() {
+    for (int i = 0; i < MAX_PLY; i++) {
+        killerMoves[i][0] = 0;
+        killerMoves[i][1] = 0;
+    }
+}
+
+void SearchWorker::updateKillers(int ply, Move move) {
+    if (ply >= MAX_PLY) return;
+    // Don't store duplicates
+    if (killerMoves[ply][0] == move) return;
+    killerMoves[ply][1] = killerMoves[ply][0];
+    killerMoves[ply][0] = move;
+}
 
-        score += mvvScore;
+inline bool SearchWorker::shouldStop() {
+    if (stopFlag->load(std::memory_order_relaxed)) return true;
+    if (stopLocal) return true;
+    // Check soft node limit on every node (worker local, no contention)
+    if (softNodeLimit > 0 && nodeCount >= softNodeLimit) {
+        stopLocal = true;
+        return true;
     }
+    if ((nodeCount & (NODE_PUBLISH_INTERVAL - 1)) == 0) {
+        return checkLimits();
+    }
+    return false;
+}
 
-    if (ttMove != 0 && move == ttMove) {
-        score += SCORE_TT_MOVE;
+// Periodic part of shouldStop(): publish our node count and, on the main thread,
+// check the node total of all threads. The hard time limit is enforced by deadlineTimer.
+bool SearchWorker::checkLimits() {
+    if (smp) smp->counters[threadId].nodes.store(nodeCount, std::memory_order_relaxed);
+    if (threadId != 0 && smp) return false;
+
+    if (nodeLimit > 0 && totalNodes() >= nodeLimit) {
+        stopLocal = true;
+        return true;
     }
+    return false;
+}
 
-    if (is_quiet(move)) {
-        // Killer move bonus (only for quiet moves)
-        if (ply < MAX_PLY && move == killerMoves[ply][0]) {
-            score += SCORE_KILLER_1;
-        } else if (ply < MAX_PLY && move == killerMoves[ply][1]) {
-            score += SCORE_KILLER_2;
-        } else {
-            score += get_history_score(board.stm, from, to);
-            score += get_conhist_score(piece - 1, to, ply);
+long long SearchWorker::totalNodes() {
+    if (!smp) return nodeCount;
+    smp->counters[threadId].nodes.store(nodeCount, std::memory_order_relaxed);
+    return smp->totalNodes();
+}
+
+inline bool SearchWorker::softNodeLimitReached() const {
+    if (softNodeLimit <= 0) return false;
+    return nodeCount >= softNodeLimit;
+}
+
+MovePicker::MovePicker(Board& board, const History& history, Move ttMove, const Move* killerMoves, int ply, bool inCheck)
+    : board(board), history(history), ttMove(ttMove), ply(ply), capturesOnly(false),
+      stage(inCheck ? STAGE_EVASION_TT_MOVE : STAGE_TT_MOVE) {
+    if (killerMoves) {
+        killers[0] = killerMoves[0];
+        killers[1] = killerMoves[1];
+    }
+}
+
+MovePicker::MovePicker(Board& board, const History& history, Move ttMove, bool inCheck)
+    : board(board), history(history), ttMove(inCheck || is_capture(ttMove) ? ttMove : 0), capturesOnly(true),
+      stage(inCheck ? STAGE_EVASION_TT_MOVE : STAGE_TT_MOVE) {}
+
+// MVV-LVA only, SEE is deferred until a capture is picked.
+void MovePicker::scoreCaptures() {
+    for (int i = cur; i < end; i++) {
+        const Move move = moves[i];
+        const int victim = move_flags(move) == FLAG_EN_PASSANT ? PAWN : piece_type(board.mailbox[move_to(move)]);
+        const int attacker = piece_type(piece_at_sq(board, move_from(move)));
+        scores[i] = PIECE_VALUES[victim] * 10 - PIECE_VALUES[attacker];
+    }
+}
+
+void MovePicker::scoreQuiets() {
+    for (int i = cur; i < end; i++) {
+        const Move move = moves[i];
+        scores[i] = 0;
+        if (is_quiet(move)) { // quiet promotions keep 0
+            const int from = move_from(move);
+            const int to = move_to(move);
+            scores[i] = history.get_history_score(board.stm, from, to)
+                      + history.get_conhist_score(board.mailbox[from] - 1, to, ply);
         }
     }
+}
 
-    return score;
+// Captures of the checker by MVV-LVA ahead of the king and blocking moves by history.
+void MovePicker::scoreEvasions() {
+    scoreQuiets();
+    for (int i = cur; i < end; i++) {
+        const Move move = moves[i];
+        if (is_capture(move)) {
+            const int victim = move_flags(move) == FLAG_EN_PASSANT ? PAWN : piece_type(board.mailbox[move_to(move)]);
+            const int attacker = piece_type(piece_at_sq(board, move_from(move)));
+            scores[i] = SCORE_GOOD_CAPTURE + PIECE_VALUES[victim] * 10 - PIECE_VALUES[attacker];
+        }
+    }
 }
 
-void orderMoves(Board& board, Move* moves, int moveCount, Move ttMove = 0, int ply = 0) {
-    int scores[MAX_MOVES];
-    for (int i = 0; i < moveCount; i++) {
-        scores[i] = scoreMove(board, moves[i], ttMove, ply);
+// Selection instead of a full sort, most nodes cut off after a few moves. Shifting keeps the
+// remaining moves in generation order, so equal scores come out in that order.
+Move MovePicker::pickBest() {
+    int best = cur;
+    for (int i = cur + 1; i < end; i++) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    const Move move = moves[best];
+    for (int i = best; i > cur; i--) {
+        moves[i] = moves[i - 1];
+        scores[i] = scores[i - 1];
     }
-    // Insertion sort with pre-computed scores
-    for (int i = 1; i < moveCount; i++) {
-        int tmpScore = scores[i];
-        Move tmpMove = moves[i];
-        int j = i - 1;
-        while (j >= 0 && scores[j] < tmpScore) {
-            scores[j + 1] = scores[j];
-            moves[j + 1] = moves[j];
-            j--;
+    cur++;
+    return move;
+}
+
+Move MovePicker::next() {
+    switch (stage) {
+    case STAGE_TT_MOVE:
+        stage = STAGE_GEN_CAPTURES;
+        if (ttMove && is_legal_move(board, ttMove)) return ttMove;
+        ttMove = 0;
+        [[fallthrough]];
+
+    case STAGE_GEN_CAPTURES:
+        get_capture_moves(board, moves, end);
+        scoreCaptures();
+        stage = STAGE_GOOD_CAPTURES;
+        [[fallthrough]];
+
+    case STAGE_GOOD_CAPTURES:
+        while (cur < end) {
+            const Move move = pickBest();
+            if (move == ttMove) continue;
+            if (staticExchangeEvaluation(board, move, SEE_THRESHOLD)) return move;
+            moves[badEnd++] = move;
+        }
+        if (capturesOnly) {
+            stage = STAGE_DONE;
+            return 0;
         }
-        scores[j + 1] = tmpScore;
-        moves[j + 1] = tmpMove;
+        stage = STAGE_KILLERS;
+        [[fallthrough]];
+
+    case STAGE_KILLERS:
+        while (killerIndex < 2) {
+            const Move killer = killers[killerIndex++];
+            if (killer && killer != ttMove && is_quiet(killer) && is_legal_move(board, killer)) return killer;
+        }
+        stage = STAGE_GEN_QUIETS;
+        [[fallthrough]];
+
+    case STAGE_GEN_QUIETS: {
+        int count = 0;
+        get_quiet_moves(board, moves + cur, count);
+        end = cur + count;
+        scoreQuiets();
+        stage = STAGE_QUIETS;
+        [[fallthrough]];
+    }
+
+    case STAGE_QUIETS:
+        while (cur < end) {
+            const Move move = pickBest();
+            if (move != ttMove && move != killers[0] && move != killers[1]) return move;
+        }
+        cur = 0;
+        stage = STAGE_BAD_CAPTURES;
+        [[fallthrough]];
+
+    case STAGE_BAD_CAPTURES:
+        if (cur < badEnd) return moves[cur++];
+        stage = STAGE_DONE;
+        return 0;
+
+    case STAGE_EVASION_TT_MOVE:
+        stage = STAGE_GEN_EVASIONS;
+        if (ttMove && is_legal_move(board, ttMove)) return ttMove;
+        ttMove = 0;
+        [[fallthrough]];
+
+    case STAGE_GEN_EVASIONS:
+        get_all_moves(board, moves, end); // the evasion generator in check
+        scoreEvasions();
+        stage = STAGE_EVASIONS;
+        [[fallthrough]];
+
+    case STAGE_EVASIONS:
+        while (cur < end) {
+            const Move move = pickBest();
+            if (move != ttMove) return move;
+        }
+        stage = STAGE_DONE;
+        [[fallthrough]];
+
+    default:
+        return 0;
     }
 }
 
-int16_t qsearch(Board& board, int16_t alpha, int16_t beta, int ply, SearchStack* ss) {
-    if (should_stop_search()) return 0;
+int16_t SearchWorker::qsearch(Board& board, int16_t alpha, int16_t beta, int ply, SearchStack* ss) {
+    if (shouldStop()) return 0;
     nodeCount++;
+    tierStats[TT_TIER_QSEARCH].nodes++;
     updateSeldepth(ply);
 
     if (ply >= 128) {
@@ -219,48 +456,65 @@ int16_t qsearch(Board& board, int16_t alpha, int16_t beta, int ply, SearchStack*
 
     int16_t originalAlpha = alpha;
     uint64_t hashKey = board.hash;
-    TTEntry& ttEntry = ttTable.getEntry(hashKey);
-    bool ttHit = (ttEntry.hashKey == hashKey);
+    TTData ttEntry;
+    // The private qsearch table first, a position negamax has already searched is only in the main one.
+    bool ttHit = qsTable.probe(hashKey, ttEntry);
+    tierStats[TT_TIER_QSEARCH].probes++;
+    tierStats[TT_TIER_QSEARCH].hits += ttHit;
+    if (!ttHit) {
+        ttHit = tt->probe(hashKey, ttEntry);
+        tierStats[TT_TIER_MAIN].probes++;
+        tierStats[TT_TIER_MAIN].hits += ttHit;
+    }
     int16_t ttScore = 0;
 
     if (ttHit) {
-        ttScore = ttEntry.score;
+        ttScore = ttEntry.score();
 
         if (ttScore >= MATE_SCORE - MAX_PLY) ttScore -= ply;
         else if (ttScore <= -MATE_SCORE + MAX_PLY) ttScore += ply;
 
-        if (ttEntry.flag == TT_EXACT) return ttScore;
-        if (ttEntry.flag == TT_BETA && ttScore <= alpha) return ttScore;
-        if (ttEntry.flag == TT_ALPHA && ttScore >= beta) return ttScore;
+        if (ttEntry.bound() == TT_EXACT) return ttScore;
+        if (ttEntry.bound() == TT_BETA && ttScore <= alpha) return ttScore;
+        if (ttEntry.bound() == TT_ALPHA && ttScore >= beta) return ttScore;
     }
 
-    int stand_pat = evaluate_board(board);
+    int kingSq = 0;
+    king_square(board, board.stm == WHITE, kingSq);
+    const bool inCheck = is_square_attacked(board, kingSq, board.stm != WHITE);
 
-    if (stand_pat >= beta) {
-        return stand_pat;
-    }
+    // In check there is no standing pat: every evasion is searched and having none is mate.
+    int16_t stand_pat = TT_EVAL_NONE;
+    int bestEval = -VALUE_INF;
+    if (!inCheck) {
+        stand_pat = (ttHit && ttEntry.eval() != TT_EVAL_NONE) ? ttEntry.eval() : static_cast<int16_t>(evaluate_board(board));
+
+        if (stand_pat >= beta) {
+            return stand_pat;
+        }
 
-    if (stand_pat > alpha) {
-        alpha = stand_pat;
+        if (stand_pat > alpha) {
+            alpha = stand_pat;
+        }
+        bestEval = stand_pat;
     }
 
-    Move captureMoves[MAX_MOVES];
-    int moveCount = 0;
-    get_capture_moves(board, captureMoves, moveCount);
-    orderMoves(board, captureMoves, moveCount, ttHit ? ttEntry.bestMove : 0, 0);
-    int bestEval = stand_pat;
+    MovePicker picker(board, history, ttHit ? ttEntry.move() : 0, inCheck);
     Move bestMove = 0;
+    int moveCount = 0;
 
-    for (int i = 0; i < moveCount; ++i) {
-        Move captureMove = captureMoves[i];
-        if (!staticExchangeEvaluation(board, captureMove, 0)) {
+    while (Move move = picker.next()) {
+        moveCount++;
+        if (!inCheck && !staticExchangeEvaluation(board, move, 0)) {
             continue; // Bad capture, skip it
         }
-        board.makeMove(captureMove);
+        board.makeMove(move);
+        qsTable.prefetch(board.hash);
+        tt->prefetch(board.hash);
         
         int eval = -qsearch(board, -beta, -alpha, ply + 1, ss + 1);
         
-        board.unmakeMove(captureMove);
+        board.unmakeMove(move);
 
         if (eval > bestEval) {
             bestEval = eval;
@@ -268,7 +522,7 @@ int16_t qsearch(Board& board, int16_t alpha, int16_t beta, int ply, SearchStack*
 
         if (eval > alpha) {
             alpha = eval;
-            bestMove = captureMove;
+            bestMove = move;
         }
 
         if (alpha >= beta) {
@@ -276,6 +530,10 @@ int16_t qsearch(Board& board, int16_t alpha, int16_t beta, int ply, SearchStack*
         }
     }
 
+    if (inCheck && moveCount == 0) {
+        return -MATE_SCORE + ply;
+    }
+
     TTFlag flag = TT_EXACT;
     if (bestEval <= originalAlpha) {
         flag = TT_BETA;
@@ -288,20 +546,21 @@ int16_t qsearch(Board& board, int16_t alpha, int16_t beta, int ply, SearchStack*
     if (ttStoreScore >= MATE_SCORE - MAX_PLY) ttStoreScore += ply;
     else if (ttStoreScore <= -MATE_SCORE + MAX_PLY) ttStoreScore -= ply;
 
-    ttTable.writeEntry(hashKey, ttStoreScore, 0, flag, bestMove);
+    qsTable.writeEntry(hashKey, ttStoreScore, stand_pat, 0, flag, bestMove);
 
     return bestEval;
 }
 
-int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, SearchStack* ss, Move pvTable[][MAX_PLY], int pvLength[], std::vector<uint64_t>& positionHistory) {
+int16_t SearchWorker::negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, SearchStack* ss, std::vector<uint64_t>& positionHistory) {
     nodeCount++;
+    tierStats[TT_TIER_MAIN].nodes++;
 
     const bool rootNode = (ply == 0);
 
     updateSeldepth(ply);
 
     pvLength[ply] = ply; // Initialize PV length for this ply
-    if (should_stop_search()) return 0;
+    if (shouldStop()) return 0;
     
     if (depth <= 0) {
         return qsearch(board, alpha, beta, ply, ss);
@@ -315,8 +574,6 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
     bool firstMove = true; // for PVS
     int16_t eval = 0; 
 
-    const int16_t staticEval = evaluate_board(board);
-    ss->staticEval = staticEval;
     ss->cutOffCount = 0;  // Initialize cutoff counter for this node
     const bool pvNode = (beta - alpha > 1);
 
@@ -330,14 +587,16 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
 
     int16_t originalAlpha = alpha;
     uint64_t hashKey = board.hash; 
-    TTEntry& ttEntry = ttTable.getEntry(hashKey);
+    TTData ttEntry;
     Move ttMove = 0;
     bool ttHit = false;
-    if (!ss->singularMove && ttEntry.hashKey == hashKey) {
-        ttMove = ttEntry.bestMove;
+    if (!ss->singularMove) tierStats[TT_TIER_MAIN].probes++;
+    if (!ss->singularMove && tt->probe(hashKey, ttEntry)) {
+        tierStats[TT_TIER_MAIN].hits++;
+        ttMove = ttEntry.move();
         ttHit = true;
-        if (ttEntry.depth >= depth && ply > 0) {
-            int16_t ttScore = ttEntry.score;
+        if (ttEntry.depth() >= depth && ply > 0) {
+            int16_t ttScore = ttEntry.score();
 
             if (ttScore >= MATE_SCORE - MAX_PLY) {
                 ttScore -= ply;
@@ -345,43 +604,46 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
                 ttScore += ply;
             }
 
-            if (ttEntry.flag == TT_EXACT) {
+            if (ttEntry.bound() == TT_EXACT) {
                 return ttScore;
             }
-            if (ttEntry.flag == TT_BETA && ttScore <= alpha) {
+            if (ttEntry.bound() == TT_BETA && ttScore <= alpha) {
                 return ttScore;
             }
-            if (ttEntry.flag == TT_ALPHA && ttScore >= beta) {
+            if (ttEntry.bound() == TT_ALPHA && ttScore >= beta) {
                 return ttScore;
             }
         
         }
+    } else if (!ss->singularMove) {
+        // Fall back to the qsearch table: a depth-0 entry never cuts here, but has a move and the static eval
+        tierStats[TT_TIER_QSEARCH].probes++;
+        if (qsTable.probe(hashKey, ttEntry)) {
+            tierStats[TT_TIER_QSEARCH].hits++;
+            ttMove = ttEntry.move();
+            ttHit = true;
+        }
+    }
+
+    // Static eval, only once the TT couldn't cut off. Reuse the TT's copy (or the parent frame's
+    // during a singular search), and skip it in check where no eval-based pruning runs.
+    int16_t staticEval = TT_EVAL_NONE;
+    if (ss->singularMove) {
+        staticEval = ss->staticEval;
+    } else if (!inCheck) {
+        staticEval = (ttHit && ttEntry.eval() != TT_EVAL_NONE) ? ttEntry.eval() : static_cast<int16_t>(evaluate_board(board));
     }
+    ss->staticEval = staticEval;
 
     // Internal Iterative Reductions (IIR)
-    if ((!ttHit || ttMove == 0 || ttEntry.depth < depth - 3) && depth >= 4) {
+    if ((!ttHit || ttMove == 0 || ttEntry.depth() < depth - 3) && depth >= 4) {
         depth--;
     }
 
 
 
-    int moveCount = 0;
-    Move moves[MAX_MOVES];
-    get_all_moves(board, moves, moveCount);
-
-    if (moveCount == 0) {
-        int kingSq = -1;
-        king_square(board, board.stm == WHITE, kingSq);
-        if ((kingSq != -1) && is_square_attacked(board, kingSq, board.stm != WHITE)) {
-            return -MATE_SCORE + ply;
-        }
-        return 0; // Stalemate
-    }
-
     int16_t bestEval = -VALUE_INF;
     bool aborted = false;
-    
-    orderMoves(board, moves, moveCount, ttMove, ply);
     Move bestMove = 0;
 
     // Reverse Futility Pruning
@@ -396,7 +658,7 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
     }
 
     // Razoring. if eval is far below alpha even the best capture, there's no point in searching. drop straight into qsearch.
-    if (!pvNode && !rootNode && depth <= 3 && staticEval + 300 + 60 * depth < alpha){
+    if (!pvNode && !rootNode && !inCheck && depth <= 3 && staticEval + 300 + 60 * depth < alpha){
         int16_t razoringScore = qsearch(board, alpha, beta, ply, ss);
 
         if (razoringScore < alpha) {
@@ -417,13 +679,14 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
         int oldEp = (prevEnPassant != -1) ? (prevEnPassant % 8) : 8;
         board.hash ^= zobrist().epFile[oldEp];
         board.hash ^= zobrist().epFile[8];
+        tt->prefetch(board.hash);
 
-        moveStack[ply] = {-1, -1}; // Sentinel for null move
+        history.moveStack[ply] = {-1, -1}; // Sentinel for null move
         positionHistory.push_back(board.hash);
 
         int R = 3 + (depth / 3);
 
-        int16_t nullScore = -negamax(board, depth - R, -beta, -beta + 1, ply + 1, ss + 1, pvTable, pvLength, positionHistory);
+        int16_t nullScore = -negamax(board, depth - R, -beta, -beta + 1, ply + 1, ss + 1, positionHistory);
         
         positionHistory.pop_back();
 
@@ -439,25 +702,53 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
     Move badQuiets[MAX_MOVES];
     int badQuietCount = 0;
     pvLength[ply] = ply;
-    for (int movesSearched = 0; movesSearched < moveCount; ++movesSearched) {
 
-        if (should_stop_search()) {
+    // ABDADA: moves another thread is already searching are deferred and searched after the rest.
+    // A deferred move keeps its original index so reductions and pruning treat it the same way.
+    const bool useAbdada = smp && smp->abdada && depth >= ABDADA_MIN_DEPTH && !ss->singularMove;
+    Move deferredMoves[MAX_MOVES];
+    int deferredIndex[MAX_MOVES];
+    int deferredCount = 0;
+    int deferredNext = 0;
+
+    MovePicker picker(board, history, ttMove, ply < MAX_PLY ? killerMoves[ply] : nullptr, ply, inCheck);
+    int moveCount = 0; // moves taken from the picker, the index reductions and pruning go by
+
+    for (;;) {
+
+        if (shouldStop()) {
             aborted = true;
             break;
         }
-        Move chosenMove = moves[movesSearched];
+        Move chosenMove = picker.next();
+        const bool deferred = chosenMove == 0;
+        int movesSearched;
+        if (!deferred) {
+            movesSearched = moveCount++;
+        } else if (deferredNext < deferredCount) {
+            movesSearched = deferredIndex[deferredNext];
+            chosenMove = deferredMoves[deferredNext++];
+        } else {
+            break;
+        }
 
         if (chosenMove == ss->singularMove) {
             continue;
         }
 
+        if (useAbdada && !deferred && !firstMove && abdada_busy(abdada_key(hashKey, chosenMove))) {
+            deferredMoves[deferredCount] = chosenMove;
+            deferredIndex[deferredCount++] = movesSearched;
+            continue;
+        }
+
         bool isKiller = (ply < MAX_PLY && is_quiet(chosenMove) && (chosenMove == killerMoves[ply][0] || chosenMove == killerMoves[ply][1]));
 
         // Singular Extensions
         int extension = 0;
-        bool trySingular = !(ply == 0) && (ply < depth * 2) && !ss->singularMove && ttHit && (chosenMove == ttMove) && depth >= 6 && (ttEntry.flag != TT_BETA) && (ttEntry.depth >= depth - 3) && abs(ttEntry.score) < MATE_SCORE - MAX_PLY;
+        bool trySingular = !(ply == 0) && (ply < depth * 2) && !ss->singularMove && ttHit && (chosenMove == ttMove) && depth >= 6 && (ttEntry.bound() != TT_BETA) && (ttEntry.depth() >= depth - 3) && abs(ttEntry.score()) < MATE_SCORE - MAX_PLY;
         if (trySingular) {
-            int16_t ttSeScore = ttEntry.score;
+            int16_t ttSeScore = ttEntry.score();
             if (ttSeScore >= MATE_SCORE - MAX_PLY) {
                 ttSeScore -= ply;
             } else if (ttSeScore <= -MATE_SCORE + MAX_PLY) {
@@ -468,7 +759,7 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
             const int singularDepth = (depth - 1) / 2;
         
             ss->singularMove = chosenMove;
-            int16_t s = negamax(board, singularDepth, singularBeta - 1, singularBeta, ply, ss, pvTable, pvLength, positionHistory);
+            int16_t s = negamax(board, singularDepth, singularBeta - 1, singularBeta, ply, ss, positionHistory);
             ss->singularMove = 0;
 
             if (s < singularBeta) {
@@ -510,19 +801,23 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
             int from = move_from(chosenMove);
             int to = move_to(chosenMove);
             int piece = board.mailbox[from] - 1;
-            int histScore = get_history_score(board.stm, from, to) + get_conhist_score(piece, to, ply);
+            int histScore = history.get_history_score(board.stm, from, to) + history.get_conhist_score(piece, to, ply);
             if (histScore < -1024 * depth) {
                 continue;
             }
         }
 
-        moveStack[ply] = {board.mailbox[move_from(chosenMove)] - 1, move_to(chosenMove)};
+        const uint64_t abdadaKey = useAbdada ? abdada_key(hashKey, chosenMove) : 0;
+        const bool marked = useAbdada && abdada_mark(abdadaKey);
+
+        history.moveStack[ply] = {board.mailbox[move_from(chosenMove)] - 1, move_to(chosenMove)};
         board.makeMove(chosenMove);
+        tt->prefetch(board.hash);
 
         positionHistory.push_back(board.hash); // Add new position to history for repetition detection
         const int fullDepth = depth - 1 + extension;
         if (firstMove){
-            eval = -negamax(board, fullDepth, -beta, -alpha, ply + 1, ss + 1, pvTable, pvLength, positionHistory);
+            eval = -negamax(board, fullDepth, -beta, -alpha, ply + 1, ss + 1, positionHistory);
             firstMove = false;
         } else {
 
@@ -541,20 +836,21 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
             int lmrDepth = std::max(0, fullDepth - reduction);
 
 
-            eval = -negamax(board, lmrDepth, -alpha - 1, -alpha, ply + 1, ss + 1, pvTable, pvLength, positionHistory); // PVS null window search
+            eval = -negamax(board, lmrDepth, -alpha - 1, -alpha, ply + 1, ss + 1, positionHistory); // PVS null window search
             
             if (reduction > 0 && eval > alpha) {
                 // if the eval suggest a better move we research
-                eval = -negamax(board, fullDepth, -alpha - 1, -alpha, ply + 1, ss + 1, pvTable, pvLength, positionHistory); // Re-search with no reduction
+                eval = -negamax(board, fullDepth, -alpha - 1, -alpha, ply + 1, ss + 1, positionHistory); // Re-search with no reduction
             }
             if (eval > alpha && eval < beta) {
                 // if we fail high search again with no reduction, and window
-                eval = -negamax(board, fullDepth, -beta, -alpha, ply + 1, ss + 1, pvTable, pvLength, positionHistory); // Re-search if we failed high
+                eval = -negamax(board, fullDepth, -beta, -alpha, ply + 1, ss + 1, positionHistory); // Re-search if we failed high
             }
         }
         if (!positionHistory.empty()) positionHistory.pop_back();
         board.unmakeMove(chosenMove);
-        if (should_stop_search()) {
+        if (marked) abdada_unmark(abdadaKey);
+        if (shouldStop()) {
             aborted = true;
             break;
         }
@@ -579,7 +875,7 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
         if (alpha >= beta) {
             ss->cutOffCount++;  // Increment cutoff counter
             if (is_quiet(chosenMove)){
-                update_history(board, board.stm, move_from(chosenMove), move_to(chosenMove), depth, badQuiets, badQuietCount, ply);
+                history.update_history(board, board.stm, move_from(chosenMove), move_to(chosenMove), depth, badQuiets, badQuietCount, ply);
                 updateKillers(ply, chosenMove);
             }
             break; // Beta cutoff
@@ -596,6 +892,10 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
         return bestEval; // Don't write to TT if search was aborted.
     }
 
+    if (moveCount == 0) {
+        return inCheck ? -MATE_SCORE + ply : 0; // Checkmate or stalemate
+    }
+
     TTFlag flag = TT_EXACT;
     if (alpha <= originalAlpha) {
         flag = TT_BETA;
@@ -611,44 +911,52 @@ int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, S
     }
     
     if (!ss->singularMove) {
-        ttTable.writeEntry(hashKey, ttScore, static_cast<int8_t>(depth), flag, bestMove);
+        tt->writeEntry(hashKey, ttScore, staticEval, static_cast<int8_t>(depth), flag, bestMove);
     }
 
 
     return bestEval;
 }
 
-Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<uint64_t>& positionHistory, int ply, bool silent, int16_t& outScore) {
+void SearchWorker::startSearch(int movetimeMs, long long nodes) {
+    stopLocal = false;
+    nodeCount = 0;
+    for (TTTierStats& stats : tierStats) stats = {};
+    qsTable.newSearch();
+    nodeLimit = nodes;
+    startTimeMs = now_ms();
+    if (movetimeMs > 0) {
+        long long safeTime = movetimeMs;
+        long long softTime = (safeTime * 7) / 10;
+        if (softTime < 1) softTime = 1;
+        softTimeLimitMs = softTime;
+        hardTimeLimitMs = safeTime;
+        timeLimited = true;
+        // The soft limit is checked between iterations, only the hard limit needs to interrupt one
+        deadlineTimer.arm(stopFlag, DeadlineTimer::Clock::now() + std::chrono::milliseconds(safeTime));
+    } else {
+        timeLimited = false;
+        softTimeLimitMs = 0;
+        hardTimeLimitMs = 0;
+    }
+}
+
+// Iterative deepening loop. The main thread (threadId 0) owns time management and reporting,
+// helpers just keep filling the shared TT until they are told to stop.
+Move SearchWorker::iterativeDeepening(Board& board, int maxDepth, const std::vector<uint64_t>& positionHistory, int ply, bool silent, int16_t& outScore) {
+    const bool mainThread = (threadId == 0 || !smp);
     int16_t score = 0;
     outScore = 0;
 
-    SearchStack ss[MAX_PLY + 8] = {};
-
-    Move pvTable[MAX_PLY][MAX_PLY];
-    int pvLength[MAX_PLY];
-    memset(pvLength, 0, sizeof(pvLength));
+    SearchStack* ss = stack;
+    std::memset(stack, 0, sizeof(stack));
+    std::memset(pvLength, 0, sizeof(pvLength));
 
     std::vector<uint64_t> searchHistory = positionHistory;
 
-    reset_movestack();
-    stop_search_local = false;
-    stop_search_global.store(false, std::memory_order_relaxed); // clear any prior UCI stop
-    resetNodeCounter();
+    history.reset_movestack();
     clearKillers();
-    const long long searchStartMs = now_ms();
-    start_time_ms = searchStartMs;
-    if (movetimeMs > 0) {
-        long long safeTime = movetimeMs;
-        long long softTime = (safeTime * 7) / 10;
-        if (softTime < 1) softTime = 1;
-        soft_time_limit_ms = softTime;
-        hard_time_limit_ms = safeTime;
-        time_limited = true;
-    } else {
-        time_limited = false;
-        soft_time_limit_ms = 0;
-        hard_time_limit_ms = 0;
-    }
+    const long long searchStartMs = startTimeMs;
 
     int moveCount = 0;
     Move moves[MAX_MOVES];
@@ -661,11 +969,23 @@ Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<u
     Move lastIterationBestMove = 0;
     double tmMultiplier = 1.0;
 
+    // Lazy SMP helpers start at staggered depths so they don't all search the same tree in lockstep,
+    // under ABDADA the busy-move deferral already spreads them out
+    const int startDepth = (mainThread || smp->abdada) ? 1 : 1 + (threadId & 1);
+
+    if (mainThread && goPending) {
+        goPending = false;
+        if (logTiming && !silent) {
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - goReceivedAt);
+            std::cout << "info string go latency " << latency.count() << " us" << std::endl;
+        }
+    }
+
     // Iterative Deepening
-    for(int iterativeDepth = 1; iterativeDepth <= maxDepth; ++iterativeDepth) {
-        resetSeldepth();
+    for(int iterativeDepth = startDepth; iterativeDepth <= maxDepth; ++iterativeDepth) {
+        seldepth = 0;
         
-        if (should_stop_search()) break;
+        if (shouldStop()) break;
         
         int16_t alpha = -VALUE_INF;
         int16_t beta = VALUE_INF;
@@ -678,9 +998,9 @@ Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<u
         }
 
         while (true) {
-            int16_t searchScore = negamax(board, iterativeDepth, alpha, beta, ply, ss, pvTable, pvLength, searchHistory);
+            int16_t searchScore = negamax(board, iterativeDepth, alpha, beta, ply, ss, searchHistory);
 
-            if (should_stop_search()) {
+            if (shouldStop()) {
                 break;
             }
 
@@ -705,7 +1025,7 @@ Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<u
             break;
         }
 
-        if (should_stop_search()) {
+        if (shouldStop()) {
             break;
         }
 
@@ -713,17 +1033,20 @@ Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<u
             bestMoveSoFar = pvTable[0][0];
         }
 
+        if (!mainThread) continue;
+
         long long elapsedMs = now_ms() - searchStartMs;
         if (elapsedMs < 0) elapsedMs = 0;
-        long long nodes = getNodeCounter();
+        long long nodes = totalNodes();
         long long nps = (elapsedMs > 0) ? (nodes * 1000 / elapsedMs) : (nodes * 1000);
         
         
         if (!silent) {
             std::cout << "info depth " << iterativeDepth
-                      << " seldepth " << getSeldepth()
-                      << " hashfull " << hash_full()
+                      << " seldepth " << seldepth
+                      << " hashfull " << tt->hashfull()
                       << " time " << elapsedMs
+                      << " nodes " << nodes
                       << " nps " << nps
                       << " score cp " << score
                       << " pv ";
@@ -733,7 +1056,6 @@ Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<u
             }
             std::cout << std::endl;
         }
-
         if (pvLength[0] > 0 && iterativeDepth > 1) {
             Move currentBestMove = pvTable[0][0];
             
@@ -757,9 +1079,9 @@ Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<u
         elapsedMs = now_ms() - searchStartMs;
         if (elapsedMs < 0) elapsedMs = 0;
         
-        long long adjustedSoftTime = (long long)(soft_time_limit_ms * tmMultiplier);
+        long long adjustedSoftTime = (long long)(softTimeLimitMs * tmMultiplier);
         
-        long long maxSafeTime = hard_time_limit_ms - 20;
+        long long maxSafeTime = hardTimeLimitMs - 20;
         if (maxSafeTime < 1) maxSafeTime = 1;
 
         if (adjustedSoftTime > maxSafeTime) {
@@ -767,15 +1089,15 @@ Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<u
         }
 
         // stop searching
-        if (time_limited && iterativeDepth >= 3 && elapsedMs >= adjustedSoftTime) {
-            stop_search_local = true;
+        if (timeLimited && iterativeDepth >= 3 && elapsedMs >= adjustedSoftTime) {
+            stopLocal = true;
             break;
         }
 
 
 
-        if (soft_node_limit_reached()) {
-            stop_search_local = true;
+        if (softNodeLimitReached()) {
+            stopLocal = true;
             break;
         }
     }
@@ -783,3 +1105,83 @@ Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<u
     outScore = score;
     return bestMoveSoFar;
 }
+
+Move SearchWorker::getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<uint64_t>& positionHistory, int ply, bool silent, int16_t& outScore) {
+    smp = nullptr;
+    stopFlag = &ownStop;
+    ownStop.store(false, std::memory_order_relaxed);
+    tt->newSearch();
+    startSearch(movetimeMs);
+    Move best = iterativeDeepening(board, maxDepth, positionHistory, ply, silent, outScore);
+    if (timeLimited) deadlineTimer.disarm(stopFlag);
+    return best;
+}
+
+Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<uint64_t>& positionHistory, int ply, bool silent, int16_t& outScore, int threads) {
+    stop_search_global.store(false, std::memory_order_relaxed); // clear any prior UCI stop
+    threads = std::max(1, threads);
+    ensureSearchWorkers(threads);
+    SearchWorker& mainWorker = *searchWorkers[0];
+    searchTable->newSearch();
+
+    lastSearchTimed = movetimeMs > 0;
+    lastSearchStart = DeadlineTimer::Clock::now();
+    lastSearchDeadline = lastSearchStart + std::chrono::milliseconds(std::max(0, movetimeMs));
+
+    if (threads == 1 || threadPool.size() < 2) {
+        mainWorker.smp = nullptr;
+        mainWorker.stopFlag = &stop_search_global;
+        mainWorker.startSearch(movetimeMs, searchNodeLimit);
+        Move best = mainWorker.iterativeDeepening(board, maxDepth, positionHistory, ply, silent, outScore);
+        if (lastSearchTimed) deadlineTimer.disarm(&stop_search_global);
+        lastSearchNodes = mainWorker.nodeCount;
+        for (int tier = 0; tier < TT_TIER_NB; ++tier) {
+            tierTotals[tier].probes += mainWorker.tierStats[tier].probes;
+            tierTotals[tier].hits += mainWorker.tierStats[tier].hits;
+            tierTotals[tier].nodes += mainWorker.tierStats[tier].nodes;
+        }
+        return best;
+    }
+
+    // Lazy SMP: every helper runs its own iterative deepening on a private board copy,
+    // the only thing they share with the main thread is the transposition table.
+    // Helpers run on the parked pool threads 1..threads-1, the caller acts as the main thread.
+    threads = std::min(threads, threadPool.size());
+    SmpContext smp(threads, smpMode == SMP_ABDADA);
+    while (static_cast<int>(helperBoards.size()) < threads - 1) {
+        helperBoards.push_back(std::make_unique<Board>());
+    }
+    for (int id = 1; id < threads; ++id) {
+        *helperBoards[id - 1] = board;
+        SearchWorker& helper = *searchWorkers[id];
+        helper.smp = &smp;
+        helper.stopFlag = &stop_search_global;
+        helper.startSearch(-1);
+        Board& helperBoard = *helperBoards[id - 1];
+        threadPool[id].run([&helper, &smp, &helperBoard, &positionHistory, maxDepth, ply, id]() {
+            int16_t helperScore = 0;
+            helper.iterativeDeepening(helperBoard, maxDepth, positionHistory, ply, true, helperScore);
+            smp.counters[id].nodes.store(helper.nodeCount, std::memory_order_relaxed);
+        });
+    }
+
+    mainWorker.smp = &smp;
+    mainWorker.stopFlag = &stop_search_global;
+    mainWorker.startSearch(movetimeMs, searchNodeLimit);
+    Move best = mainWorker.iterativeDeepening(board, maxDepth, positionHistory, ply, silent, outScore);
+    if (lastSearchTimed) deadlineTimer.disarm(&stop_search_global);
+
+    stop_search_global.store(true, std::memory_order_relaxed); // the main thread is done, stop the helpers
+    for (int id = 1; id < threads; ++id) threadPool[id].wait();
+
+    lastSearchNodes = mainWorker.totalNodes();
+    for (int id = 0; id < threads; ++id) {
+        for (int tier = 0; tier < TT_TIER_NB; ++tier) {
+            tierTotals[tier].probes += searchWorkers[id]->tierStats[tier].probes;
+            tierTotals[tier].hits += searchWorkers[id]->tierStats[tier].hits;
+            tierTotals[tier].nodes += searchWorkers[id]->tierStats[tier].nodes;
+        }
+    }
+    for (int id = 0; id < threads; ++id) searchWorkers[id]->smp = nullptr;
+    return best;
+}
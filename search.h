@@ -3,6 +3,14 @@
 
 #include "board.h"
 
+#include "history.h"
+#include "tt.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 extern void initLMRtables();
 void resetNodeCounter();
 long long getNodeCounter();
@@ -14,79 +22,158 @@ struct SearchStack {
     int16_t staticEval;
 };
 
-int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, SearchStack* ss, Move pvTable[][MAX_PLY], int pvLength[], std::vector<uint64_t>& positionHistory);
+struct SmpContext;
+class TranspositionTable;
 
-Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<uint64_t>& positionHistory, int ply, bool silent, int16_t& outScore);
+// The two TT tiers: the shared main table holds negamax results (depth >= 1), every worker keeps
+// its qsearch (depth 0) entries in a private table small enough to stay in L2.
+enum TTTier { TT_TIER_MAIN, TT_TIER_QSEARCH, TT_TIER_NB };
 
-void setSoftNodeLimit(long long nodes); // 0 or negative = no limit
+constexpr int QSEARCH_TT_MB = 1;
 
-enum TTFlag : uint8_t {
-    TT_EXACT, // Exact Score (PV Node)
-    TT_ALPHA, // Lower bound (Fail-High)
-    TT_BETA   // Upper bound (Fail-Low)
+struct TTTierStats {
+    long long probes = 0;
+    long long hits = 0;
+    long long nodes = 0; // negamax nodes for the main tier, qsearch nodes for the qsearch tier
 };
 
+// Hands out the moves of a node one at a time. Each stage is generated and scored only when the
+// search gets to it, so a TT move cutoff never pays for move generation or SEE:
+// TT move, good captures, killers, quiets (best history first), bad captures.
+// The qsearch picker stops after the good captures. In check both go through the TT move and
+// then all evasions, captures first.
+class MovePicker {
+public:
+    MovePicker(Board& board, const History& history, Move ttMove, const Move* killers, int ply, bool inCheck);
+    MovePicker(Board& board, const History& history, Move ttMove, bool inCheck); // qsearch
 
-struct TTEntry { // 16 bytes total
-    uint64_t hashKey;
-    int16_t score;
-    int8_t depth;
-    TTFlag flag;
-    Move bestMove;
-};
+    Move next(); // 0 once every move has been returned
 
-class TranspositionTable {
 private:
-    std::vector<TTEntry> table;
+    enum Stage {
+        STAGE_TT_MOVE, STAGE_GEN_CAPTURES, STAGE_GOOD_CAPTURES, STAGE_KILLERS,
+        STAGE_GEN_QUIETS, STAGE_QUIETS, STAGE_BAD_CAPTURES,
+        STAGE_EVASION_TT_MOVE, STAGE_GEN_EVASIONS, STAGE_EVASIONS, STAGE_DONE
+    };
+
+    void scoreCaptures();
+    void scoreQuiets();
+    void scoreEvasions();
+    Move pickBest();
+
+    Board& board;
+    const History& history;
+    Move ttMove;
+    Move killers[2] = {0, 0};
+    int ply = 0;
+    bool capturesOnly;
+    int stage = STAGE_TT_MOVE;
+
+    // Captures first, quiets appended behind them. Captures failing SEE are moved to the
+    // front of the list as they are picked and come back in the last stage.
+    Move moves[256];
+    int scores[256];
+    int cur = 0;
+    int end = 0;
+    int badEnd = 0;
+    int killerIndex = 0;
+};
 
+// Owns every piece of mutable search state, so several searches can run in one process
+// without sharing history tables or cache lines. Allocate on the heap, the tables are large.
+class alignas(64) SearchWorker {
 public:
-    TranspositionTable() {
-        resize(128); // 128 MB default size
-    }
-
-    void resize(int mbSize) {
-        // 1 MB = 1024 * 1024 byte
-        size_t numEntries = (mbSize * 1024ULL * 1024ULL) / sizeof(TTEntry);
-        
-        table.clear();
-        table.resize(numEntries);
-    }
-
-    void clear() {
-        // reset all entries to default values
-        for (auto& entry : table) {
-            entry = TTEntry{};
-        }
-    }
-
-    int count() const {
-        return static_cast<int>(table.size());
-    }
-
-    // TT get entry by hash key
-    TTEntry& getEntry(uint64_t hashKey) {
-        return table[hashKey % table.size()];
-    }
-
-    void writeEntry(uint64_t hashKey, int16_t score, int8_t depth, TTFlag flag, Move bestMove) {
-        TTEntry& entry = getEntry(hashKey);
-        
-        bool isNewPosition = (entry.hashKey != hashKey);
-
-        if (isNewPosition || depth > entry.depth || (depth == entry.depth && flag == TT_EXACT)) {
-            entry.hashKey = hashKey;
-            entry.score = score;
-            entry.depth = depth;
-            entry.flag = flag;
-            
-            if (bestMove != 0 || isNewPosition) {
-                entry.bestMove = bestMove;
-            }
-        }
-    }
+    explicit SearchWorker(int threadId = 0);
+
+    // Single threaded search with this worker's own state.
+    Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<uint64_t>& positionHistory, int ply, bool silent, int16_t& outScore);
+
+    void clearHistory();
+    void clearQSearchTable() { qsTable.clear(); }
+    // Searches probe and fill the global ttTable unless given a private table (datagen workers).
+    void setTranspositionTable(TranspositionTable* table) { tt = table; }
+    void setSoftNodeLimit(long long nodes) { softNodeLimit = nodes; } // 0 or negative = no limit
+    long long getNodeCount() const { return nodeCount; }
+
+private:
+    friend Move getBestMove(Board&, int, int, const std::vector<uint64_t>&, int, bool, int16_t&, int);
+
+    void startSearch(int movetimeMs, long long nodes = -1);
+    Move iterativeDeepening(Board& board, int maxDepth, const std::vector<uint64_t>& positionHistory, int ply, bool silent, int16_t& outScore);
+    int16_t negamax(Board& board, int depth, int16_t alpha, int16_t beta, int ply, SearchStack* ss, std::vector<uint64_t>& positionHistory);
+    int16_t qsearch(Board& board, int16_t alpha, int16_t beta, int ply, SearchStack* ss);
+
+    void clearKillers();
+    void updateKillers(int ply, Move move);
+
+    bool shouldStop();
+    bool checkLimits();
+    long long totalNodes(); // this search's nodes, over all threads when part of a Lazy SMP search
+    bool softNodeLimitReached() const;
+    void updateSeldepth(int ply) { if (ply > seldepth) seldepth = ply; }
+
+    int threadId;
+    SmpContext* smp = nullptr; // set while running as part of a multi-threaded search
+    TranspositionTable* tt;
+    // The only thing the hot path polls. Raised by `stop`, the deadline timer or the main thread
+    // once it is done; points at ownStop for searches started through the member getBestMove().
+    std::atomic<bool>* stopFlag;
+    std::atomic<bool> ownStop{false};
+
+    History history;
+    Move killerMoves[MAX_PLY][2];
+    SearchStack stack[MAX_PLY + 8];
+    Move pvTable[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+
+    long long nodeCount = 0;
+    long long softNodeLimit = -1;
+    long long nodeLimit = -1;      // hard limit on the node total of all threads, main thread only
+    long long startTimeMs = 0;
+    long long softTimeLimitMs = 0;
+    long long hardTimeLimitMs = 0;
+    bool timeLimited = false;
+    bool stopLocal = false;
+    int seldepth = 0;
+
+    TranspositionTable qsTable{QSEARCH_TT_MB, false};
+    TTTierStats tierStats[TT_TIER_NB];
 };
 
-// Global TT
-extern TranspositionTable ttTable;
+// Per-tier TT counters summed over all searches since the last reset, for `bench`.
+void resetTTTierStats();
+TTTierStats getTTTierStats(TTTier tier);
+
+// Empties the qsearch tables of the pooled workers, so `bench` doesn't depend on earlier searches.
+void clearQSearchTables();
+
+// Clears the history of every pooled search worker (new game / new position).
+void clearSearchHistory();
+
+// Points the pooled search workers at `table`, nullptr puts them back on ttTable. Lets `bench`
+// search a private table while ttTable is shared with other processes.
+void setSearchTranspositionTable(TranspositionTable* table);
+
+// threads > 1 runs a Lazy SMP search: helpers search board copies and share ttTable,
+// the calling thread reports the PV and returns the best move. Helpers run on threadPool threads
+// 1..threads-1, so the caller must not be one of them (the UCI loop calls this from pool thread 0).
+Move getBestMove(Board& board, int maxDepth, int movetimeMs, const std::vector<uint64_t>& positionHistory, int ply, bool silent, int16_t& outScore, int threads = 1);
+
+void setNodeLimit(long long nodes); // `go nodes` limit for the next search, 0 or negative = no limit
+void setSearchThreads(int threads);
+int getSearchThreads();
+
+// How the threads of a multi-threaded search cooperate.
+// SMP_LAZY:   helpers only share the TT.
+// SMP_ABDADA: threads also publish the moves they are searching, and siblings defer those moves.
+enum SmpMode { SMP_LAZY, SMP_ABDADA };
+void setSmpMode(SmpMode mode);
+SmpMode getSmpMode();
+
+// Instrumentation: report the latency from `go` to the start of the root search as an info string.
+void setLogTiming(bool enabled);
+void markGoReceived();
+// Call right before printing `bestmove`: reports how far from its hard deadline the last timed search is.
+void logBestmoveTiming();
 
 #endif
@@ -0,0 +1,119 @@
+#include "threadpool.h"
+#include "numa.h"
+
+#include <algorithm>
+
+ThreadPool threadPool;
+DeadlineTimer deadlineTimer;
+
+PooledThread::PooledThread(int index) : idx(index) {
+    searching = true; // the thread reports itself idle once it is parked
+    thread = std::thread(&PooledThread::idleLoop, this);
+    wait();
+}
+
+PooledThread::~PooledThread() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+        searching = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+void PooledThread::run(std::function<void()> newJob) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = std::move(newJob);
+        searching = true;
+    }
+    cv.notify_all();
+}
+
+void PooledThread::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !searching; });
+}
+
+void PooledThread::idleLoop() {
+    numa_bind_thread(idx); // no-op unless NUMA mode is on
+
+    while (true) {
+        std::function<void()> current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            searching = false;
+            cv.notify_all(); // wake up anyone waiting for the job to finish
+            cv.wait(lock, [this] { return searching; });
+            if (exiting) return;
+            current = std::move(job);
+        }
+        if (current) current();
+    }
+}
+
+void ThreadPool::resize(int count) {
+    count = std::max(1, count);
+    waitAll();
+    while (size() > count) threads.pop_back();
+    while (size() < count) threads.push_back(std::make_unique<PooledThread>(size()));
+}
+
+void ThreadPool::rebind() {
+    const int count = size();
+    waitAll();
+    threads.clear();
+    resize(count);
+}
+
+void ThreadPool::waitAll() {
+    for (auto& t : threads) t->wait();
+}
+
+DeadlineTimer::~DeadlineTimer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void DeadlineTimer::arm(std::atomic<bool>* flag, Clock::time_point deadline) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!thread.joinable()) thread = std::thread(&DeadlineTimer::timerLoop, this);
+        auto it = std::find_if(deadlines.begin(), deadlines.end(), [flag](const Deadline& d) { return d.flag == flag; });
+        if (it != deadlines.end()) it->when = deadline;
+        else deadlines.push_back({flag, deadline});
+    }
+    cv.notify_all();
+}
+
+void DeadlineTimer::disarm(std::atomic<bool>* flag) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::erase_if(deadlines, [flag](const Deadline& d) { return d.flag == flag; });
+}
+
+void DeadlineTimer::timerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!exiting) {
+        if (deadlines.empty()) {
+            cv.wait(lock);
+            continue;
+        }
+
+        auto earliest = std::min_element(deadlines.begin(), deadlines.end(),
+                                         [](const Deadline& a, const Deadline& b) { return a.when < b.when; });
+        const Clock::time_point when = earliest->when; // copy, the vector may change while we sleep
+        if (Clock::now() < when) {
+            cv.wait_until(lock, when); // re-evaluated after an arm/disarm or spurious wakeup
+            continue;
+        }
+
+        earliest->flag->store(true, std::memory_order_relaxed);
+        deadlines.erase(earliest);
+    }
+}
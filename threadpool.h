@@ -0,0 +1,91 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A thread that is created once and parks on a condition variable between jobs,
+// so starting a search doesn't pay for thread creation and teardown.
+class PooledThread {
+public:
+    explicit PooledThread(int index);
+    ~PooledThread();
+
+    PooledThread(const PooledThread&) = delete;
+    PooledThread& operator=(const PooledThread&) = delete;
+
+    // Hands a job to the parked thread and returns immediately. The thread must be idle.
+    void run(std::function<void()> job);
+    // Blocks until the current job (if any) has finished.
+    void wait();
+
+private:
+    void idleLoop();
+
+    int idx;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::function<void()> job;
+    bool searching = false;
+    bool exiting = false;
+    std::thread thread;
+};
+
+// Persistent search threads. Thread 0 runs the UCI commands that must not block the input loop
+// (go, bench, perft), threads 1..n-1 are the Lazy SMP helpers.
+class ThreadPool {
+public:
+    // Grows or shrinks the pool, all threads must be idle.
+    void resize(int count);
+    int size() const { return static_cast<int>(threads.size()); }
+    // Recreates every thread, e.g. so they pick up a new NUMA binding.
+    void rebind();
+
+    PooledThread& operator[](int i) { return *threads[i]; }
+    PooledThread& main() { return *threads[0]; }
+
+    void waitAll();
+
+private:
+    std::vector<std::unique_ptr<PooledThread>> threads;
+};
+
+extern ThreadPool threadPool;
+
+// Sleeps until the earliest armed deadline and then raises that search's stop flag, so searches
+// only ever poll the flag and never read the clock in the hot path.
+class DeadlineTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ~DeadlineTimer();
+
+    // Sets *flag to true at `deadline` unless disarmed first. One deadline per flag.
+    void arm(std::atomic<bool>* flag, Clock::time_point deadline);
+    // Once this returns the timer will no longer touch *flag.
+    void disarm(std::atomic<bool>* flag);
+
+private:
+    struct Deadline {
+        std::atomic<bool>* flag;
+        Clock::time_point when;
+    };
+
+    void timerLoop();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Deadline> deadlines;
+    bool exiting = false;
+    std::thread thread; // started on the first arm()
+};
+
+extern DeadlineTimer deadlineTimer;
+
+#endif
@@ -0,0 +1,443 @@
+#include "tt.h"
+#include "numa.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+constexpr size_t SMALL_PAGE_SIZE = 4096;
+
+// Bump whenever TTData or TTCluster change layout, older snapshots and shared tables are then refused.
+constexpr uint32_t TT_FORMAT_VERSION = 1;
+constexpr char TT_FILE_MAGIC[8] = {'S', 'O', 'L', 'O', 'H', 'A', 'S', 'H'};
+constexpr char TT_SHARED_MAGIC[8] = {'S', 'O', 'L', 'O', 'S', 'H', 'T', 'T'};
+
+struct alignas(64) TTFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t clusterBytes;
+    uint64_t zobristSeed;
+    uint64_t numClusters;
+    uint64_t mbSize;
+    uint8_t generation;
+};
+
+static_assert(sizeof(TTFileHeader) == 64, "the clusters must stay cache line aligned in a mapped file");
+
+// Start of a shared memory table, the clusters follow. Written once by the creating process.
+struct alignas(64) TTSharedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t clusterBytes;
+    uint64_t zobristSeed;
+    uint64_t numClusters;
+    uint64_t mbSize;
+    std::atomic<uint32_t> users;
+    std::atomic<uint8_t> generation;
+};
+
+static_assert(sizeof(TTSharedHeader) == 64, "the clusters must stay cache line aligned in shared memory");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint8_t>::is_always_lock_free,
+              "header counters are shared between processes");
+
+#ifdef __linux__
+// AnonHugePages (kB) of the mapping containing addr, i.e. how much of it THP actually backs.
+size_t anon_huge_kb(const void* addr) {
+    std::ifstream smaps("/proc/self/smaps");
+    const unsigned long long target = reinterpret_cast<uintptr_t>(addr);
+    std::string line;
+    bool inMapping = false;
+    while (std::getline(smaps, line)) {
+        unsigned long long start = 0, end = 0;
+        if (std::sscanf(line.c_str(), "%llx-%llx ", &start, &end) == 2) { // a new mapping starts
+            if (inMapping) break;
+            inMapping = (target >= start && target < end);
+            continue;
+        }
+        if (inMapping && line.rfind("AnonHugePages:", 0) == 0) {
+            return std::stoull(line.substr(14));
+        }
+    }
+    return 0;
+}
+#endif
+
+void free_table(TTCluster* table, size_t allocBytes, TTPages pages) {
+#ifdef __linux__
+    if (pages == TTPages::HugeTLB) {
+        munmap(table, allocBytes);
+        return;
+    }
+    if (pages == TTPages::File) {
+        munmap(reinterpret_cast<char*>(table) - sizeof(TTFileHeader), allocBytes);
+        return;
+    }
+    if (pages == TTPages::Shared) {
+        munmap(reinterpret_cast<char*>(table) - sizeof(TTSharedHeader), allocBytes);
+        return;
+    }
+#endif
+    const size_t alignment = allocBytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : SMALL_PAGE_SIZE;
+    ::operator delete(table, std::align_val_t(alignment));
+}
+
+// Runs fn(begin, end) over [0, count) clusters, one slice per 256 MB up to the core count. Small
+// tables stay on the calling thread, so a private table is still first-touched by its owner.
+template <typename Fn>
+void for_each_slice(size_t count, Fn fn) {
+    constexpr size_t CLUSTERS_PER_THREAD = (256ULL * 1024 * 1024) / sizeof(TTCluster);
+    const size_t cores = std::max(1U, std::thread::hardware_concurrency());
+    const size_t threads = std::clamp<size_t>(count / CLUSTERS_PER_THREAD, 1, cores);
+    const size_t slice = count / threads;
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) {
+        const size_t begin = t * slice;
+        const size_t end = (t + 1 == threads) ? count : begin + slice;
+        workers.emplace_back(fn, begin, end);
+    }
+    fn(size_t(0), threads == 1 ? count : slice);
+    for (auto& w : workers) w.join();
+}
+
+} // namespace
+
+const char* tt_pages_name(TTPages pages) {
+    switch (pages) {
+        case TTPages::HugeTLB: return "2MB pages (hugetlb)";
+        case TTPages::Transparent: return "2MB pages (transparent)";
+        case TTPages::File: return "a mapped hash file";
+        case TTPages::Shared: return "shared memory";
+        default: return "4KB pages";
+    }
+}
+
+void TranspositionTable::release() {
+    if (!table) return;
+    if (pages == TTPages::Shared) detachShared();
+    free_table(table, allocBytes, pages);
+    table = nullptr;
+}
+
+size_t TranspositionTable::resize(size_t mb) {
+    const size_t oldMb = table ? mbSize : 0;
+    release();
+    return allocateFitting(mb, oldMb);
+}
+
+bool TranspositionTable::rehash(size_t mb) {
+    TTCluster* const from = table;
+    const size_t oldCount = numClusters;
+    const size_t oldBytes = allocBytes;
+    const TTPages oldPages = pages;
+    if (pages == TTPages::Shared) detachShared(); // the mapping stays until the migration is done
+    const size_t oldMb = mbSize;
+    table = nullptr;
+    if (!allocate(mb)) {
+        if (from) free_table(from, oldBytes, oldPages);
+        allocateFitting(mb, from ? oldMb : 0);
+        return false;
+    }
+    if (!from) return true;
+
+    const size_t newCount = numClusters;
+    for_each_slice(newCount, [this, from, oldCount, newCount](size_t begin, size_t end) {
+        using u128 = unsigned __int128;
+        for (size_t c = begin; c < end; ++c) {
+            // Keys that index cluster c here: [ceil(c * 2^64 / newCount), ceil((c + 1) * 2^64 / newCount))
+            const uint64_t firstKey = static_cast<uint64_t>(((u128(c) << 64) + newCount - 1) / newCount);
+            const uint64_t lastKey = static_cast<uint64_t>(((u128(c + 1) << 64) + newCount - 1) / newCount - 1);
+            const size_t firstOld = static_cast<size_t>((u128(firstKey) * oldCount) >> 64);
+            const size_t lastOld = static_cast<size_t>((u128(lastKey) * oldCount) >> 64);
+
+            uint64_t data[TT_CLUSTER_SIZE] = {};
+            uint16_t keys[TT_CLUSTER_SIZE] = {};
+            for (size_t o = firstOld; o <= lastOld; ++o) {
+                for (int j = 0; j < TT_CLUSTER_SIZE; ++j) {
+                    const TTData entry(from[o].data[j].load(std::memory_order_relaxed));
+                    if (entry.raw() == 0) continue;
+                    const int value = entry.depth() - 8 * age(entry);
+
+                    int slot = 0;
+                    int slotValue = INT_MAX;
+                    for (int k = 0; k < TT_CLUSTER_SIZE; ++k) {
+                        const TTData kept(data[k]);
+                        const int keptValue = data[k] == 0 ? INT_MIN : kept.depth() - 8 * age(kept);
+                        if (keptValue < slotValue) {
+                            slotValue = keptValue;
+                            slot = k;
+                        }
+                    }
+                    if (value <= slotValue) continue;
+                    data[slot] = entry.raw();
+                    keys[slot] = from[o].keys[j].load(std::memory_order_relaxed); // key bits don't depend on the size
+                }
+            }
+            for (int k = 0; k < TT_CLUSTER_SIZE; ++k) {
+                table[c].data[k].store(data[k], std::memory_order_relaxed);
+                table[c].keys[k].store(keys[k], std::memory_order_relaxed);
+            }
+        }
+    });
+    free_table(from, oldBytes, oldPages);
+    return true;
+}
+
+bool TranspositionTable::allocate(size_t mb) {
+    // 1 MB = 1024 * 1024 byte
+    mbSize = mb;
+    numClusters = std::max<size_t>(1, (mb * 1024ULL * 1024ULL) / sizeof(TTCluster));
+    const size_t bytes = numClusters * sizeof(TTCluster);
+    const bool huge = bytes >= HUGE_PAGE_SIZE;
+    allocBytes = huge ? (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE : bytes;
+
+    void* mem = nullptr;
+    pages = TTPages::Small;
+#ifdef __linux__
+    // Explicit huge pages first, they only exist if the admin reserved some (vm.nr_hugepages)
+    if (huge) {
+        mem = mmap(nullptr, allocBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mem == MAP_FAILED) mem = nullptr;
+        else pages = TTPages::HugeTLB;
+    }
+#endif
+    if (!mem) {
+        mem = ::operator new(allocBytes, std::align_val_t(huge ? HUGE_PAGE_SIZE : SMALL_PAGE_SIZE), std::nothrow);
+        if (!mem) {
+            mbSize = numClusters = allocBytes = 0;
+            return false;
+        }
+#ifdef __linux__
+        if (huge) madvise(mem, allocBytes, MADV_HUGEPAGE);
+#endif
+    }
+    table = static_cast<TTCluster*>(mem);
+
+    // Placement policy has to be set before the first touch, then touching every cluster pre-faults
+    // the whole table here instead of during the first search.
+    if (interleaved) numa_interleave(table, allocBytes); // no-op unless NUMA mode is on
+    TTCluster* clusters = table;
+    for_each_slice(numClusters, [clusters](size_t begin, size_t end) {
+        std::uninitialized_value_construct_n(clusters + begin, end - begin);
+    });
+
+#ifdef __linux__
+    if (pages == TTPages::Small && huge && anon_huge_kb(table) > 0) pages = TTPages::Transparent;
+#endif
+    return true;
+}
+
+size_t TranspositionTable::allocateFitting(size_t mb, size_t fallbackMb) {
+    if (allocate(mb)) return mb;
+    for (size_t next = (fallbackMb != 0 && fallbackMb < mb) ? fallbackMb : mb / 2; next >= 1; next /= 2) {
+        if (allocate(next)) return next;
+    }
+    throw std::bad_alloc(); // nothing left to search with
+}
+
+void TranspositionTable::clear() {
+    // reset all entries to default values
+    TTCluster* clusters = table;
+    for_each_slice(numClusters, [clusters](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            for (int j = 0; j < TT_CLUSTER_SIZE; ++j) {
+                clusters[i].data[j].store(0, std::memory_order_relaxed);
+                clusters[i].keys[j].store(0, std::memory_order_relaxed);
+            }
+        }
+    });
+}
+
+int TranspositionTable::hashfull() const {
+    int used = 0;
+    const size_t samples = std::min<size_t>(1000 / TT_CLUSTER_SIZE, numClusters);
+    for (size_t i = 0; i < samples; ++i) {
+        for (int j = 0; j < TT_CLUSTER_SIZE; ++j) {
+            const TTData entry(table[i].data[j].load(std::memory_order_relaxed));
+            if (entry.raw() != 0 && age(entry) == 0) used++;
+        }
+    }
+    return used * 1000 / static_cast<int>(samples * TT_CLUSTER_SIZE);
+}
+
+bool TranspositionTable::save(const std::string& path) const {
+    TTFileHeader header{};
+    std::memcpy(header.magic, TT_FILE_MAGIC, sizeof(header.magic));
+    header.version = TT_FORMAT_VERSION;
+    header.clusterBytes = sizeof(TTCluster);
+    header.zobristSeed = Zobrist::SEED;
+    header.numClusters = numClusters;
+    header.mbSize = mbSize;
+    header.generation = currentGeneration();
+
+    // Written next to the target and renamed over it, so a table mapped from the old file keeps its pages.
+    const std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table), static_cast<std::streamsize>(numClusters * sizeof(TTCluster)));
+    out.close();
+    if (!out || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool TranspositionTable::load(const std::string& path) {
+#ifdef __linux__
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    TTFileHeader header{};
+    const bool valid = fstat(fd, &st) == 0
+                    && pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+                    && std::memcmp(header.magic, TT_FILE_MAGIC, sizeof(header.magic)) == 0
+                    && header.version == TT_FORMAT_VERSION
+                    && header.clusterBytes == sizeof(TTCluster)
+                    && header.zobristSeed == Zobrist::SEED
+                    && header.numClusters > 0
+                    && static_cast<uint64_t>(st.st_size) == sizeof(header) + header.numClusters * sizeof(TTCluster);
+
+    // Private mapping: pages come from the page cache on first touch and are copied only once the
+    // search writes to them.
+    void* mem = valid ? mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd); // the mapping keeps its own reference
+    if (mem == MAP_FAILED) return false;
+    madvise(mem, st.st_size, MADV_WILLNEED); // start reading the file in behind our back
+
+    release();
+    table = reinterpret_cast<TTCluster*>(static_cast<char*>(mem) + sizeof(TTFileHeader));
+    numClusters = header.numClusters;
+    allocBytes = st.st_size;
+    mbSize = header.mbSize;
+    pages = TTPages::File;
+    generation = header.generation & 0x3F;
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+bool TranspositionTable::attachShared(const std::string& name, size_t mb) {
+#ifdef __linux__
+    // Retried when the last user removes the object between our open and our lock
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd < 0) return false;
+        flock(fd, LOCK_EX);
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        if (st.st_nlink == 0) { // unlinked while we waited for the lock
+            close(fd);
+            continue;
+        }
+
+        // Size negotiation: an empty object is ours to set up, otherwise its header decides
+        const bool create = (st.st_size == 0);
+        const size_t clusters = std::max<size_t>(1, (mb * 1024ULL * 1024ULL) / sizeof(TTCluster));
+        const size_t bytes = create ? sizeof(TTSharedHeader) + clusters * sizeof(TTCluster) : static_cast<size_t>(st.st_size);
+        void* mem = MAP_FAILED;
+        // Reserved, not just truncated: pages a full /dev/shm can't back would SIGBUS on first touch
+        if (!create || posix_fallocate(fd, 0, static_cast<off_t>(bytes)) == 0) {
+            mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (mem == MAP_FAILED) {
+            if (create) shm_unlink(name.c_str());
+            flock(fd, LOCK_UN);
+            close(fd);
+            return false;
+        }
+
+        auto* header = static_cast<TTSharedHeader*>(mem);
+        if (create) { // the clusters of a fresh object are already zero
+            std::memcpy(header->magic, TT_SHARED_MAGIC, sizeof(header->magic));
+            header->version = TT_FORMAT_VERSION;
+            header->clusterBytes = sizeof(TTCluster);
+            header->zobristSeed = Zobrist::SEED;
+            header->numClusters = clusters;
+            header->mbSize = mb;
+        } else if (bytes < sizeof(TTSharedHeader)
+                || std::memcmp(header->magic, TT_SHARED_MAGIC, sizeof(header->magic)) != 0
+                || header->version != TT_FORMAT_VERSION
+                || header->clusterBytes != sizeof(TTCluster)
+                || header->zobristSeed != Zobrist::SEED
+                || bytes != sizeof(TTSharedHeader) + header->numClusters * sizeof(TTCluster)) {
+            munmap(mem, bytes);
+            flock(fd, LOCK_UN);
+            close(fd);
+            return false;
+        }
+        header->users.fetch_add(1, std::memory_order_relaxed);
+        flock(fd, LOCK_UN); // explicitly, the mapping keeps the open file (and so a flock) alive
+        close(fd);
+
+        release();
+        table = reinterpret_cast<TTCluster*>(static_cast<char*>(mem) + sizeof(TTSharedHeader));
+        numClusters = header->numClusters;
+        allocBytes = bytes;
+        mbSize = header->mbSize;
+        pages = TTPages::Shared;
+        sharedName = name;
+        sharedInode = st.st_ino;
+        sharedGeneration = &header->generation;
+        generation = header->generation.load(std::memory_order_relaxed) & 0x3F;
+        return true;
+    }
+#else
+    (void)name;
+    (void)mb;
+#endif
+    return false;
+}
+
+void TranspositionTable::detachShared() {
+#ifdef __linux__
+    auto* header = reinterpret_cast<TTSharedHeader*>(reinterpret_cast<char*>(table) - sizeof(TTSharedHeader));
+    const int fd = shm_open(sharedName.c_str(), O_RDWR, 0);
+    if (fd >= 0) flock(fd, LOCK_EX);
+    const bool last = header->users.fetch_sub(1, std::memory_order_relaxed) == 1;
+
+    // Only remove the name if it still refers to our object, someone may have replaced it
+    struct stat st{};
+    if (last && fd >= 0 && fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_ino) == sharedInode) {
+        shm_unlink(sharedName.c_str());
+    }
+    if (fd >= 0) {
+        flock(fd, LOCK_UN);
+        close(fd);
+    }
+#endif
+    sharedName.clear();
+    sharedInode = 0;
+    generation = currentGeneration(); // a rehash still ages the migrated entries by the shared count
+    sharedGeneration = nullptr;
+}
+
+uint32_t TranspositionTable::sharedUsers() const {
+    if (pages != TTPages::Shared) return 0;
+    auto* header = reinterpret_cast<const TTSharedHeader*>(reinterpret_cast<const char*>(table) - sizeof(TTSharedHeader));
+    return header->users.load(std::memory_order_relaxed);
+}
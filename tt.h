@@ -0,0 +1,248 @@
+#ifndef TT_H
+#define TT_H
+
+#include "board.h"
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum TTFlag : uint8_t {
+    TT_EXACT, // Exact Score (PV Node)
+    TT_ALPHA, // Lower bound (Fail-High)
+    TT_BETA   // Upper bound (Fail-Low)
+};
+
+// Stored in the eval field when no static eval is known (e.g. the node was in check).
+constexpr int16_t TT_EVAL_NONE = INT16_MIN;
+
+// One entry packed into a single 64-bit word:
+// move (16) | score (16) | static eval (16) | depth (8) | bound + 1 (2) | generation (6)
+// The bound is stored off by one so an occupied entry never packs to 0.
+class TTData {
+public:
+    TTData() = default;
+    explicit TTData(uint64_t word) : word(word) {}
+
+    static TTData pack(Move move, int16_t score, int16_t eval, int8_t depth, TTFlag bound, uint8_t generation) {
+        return TTData(static_cast<uint64_t>(move)
+                    | (static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16)
+                    | (static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 32)
+                    | (static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48)
+                    | (static_cast<uint64_t>(bound + 1) << 56)
+                    | (static_cast<uint64_t>(generation & 0x3F) << 58));
+    }
+
+    Move move() const { return static_cast<Move>(word & 0xFFFF); }
+    int16_t score() const { return static_cast<int16_t>(word >> 16); }
+    int16_t eval() const { return static_cast<int16_t>(word >> 32); }
+    int depth() const { return static_cast<int8_t>(word >> 48); }
+    TTFlag bound() const { return static_cast<TTFlag>(((word >> 56) & 0x3) - 1); }
+    uint8_t generation() const { return static_cast<uint8_t>(word >> 58); }
+    uint64_t raw() const { return word; }
+
+private:
+    uint64_t word = 0;
+};
+
+// Six 10-byte entries per cache line: the data words plus a 16-bit verification key each, the
+// index bits supply the rest of the key. The key is stored XOR-ed with a fold of the data word,
+// so an entry torn by two threads writing at once (almost always) fails verification on probe.
+constexpr int TT_CLUSTER_SIZE = 6;
+
+struct alignas(64) TTCluster {
+    std::atomic<uint64_t> data[TT_CLUSTER_SIZE];
+    std::atomic<uint16_t> keys[TT_CLUSTER_SIZE];
+};
+
+static_assert(sizeof(TTCluster) == 64, "a TT cluster must fill exactly one cache line");
+
+// Largest Hash setting in MB (32 TB), the 64-bit index math has room for far more.
+constexpr long long TT_MAX_MB = 33554432;
+
+// How the table memory is backed.
+// HugeTLB:     explicit 2 MB pages (MAP_HUGETLB), needs pages reserved by the admin.
+// Transparent: 2 MB aligned and madvise(MADV_HUGEPAGE), the kernel backed it with huge pages.
+// Small:       regular 4 KB pages, the fallback.
+// File:        a private (copy-on-write) mapping of a file written by save().
+// Shared:      a POSIX shared memory object other engine processes have mapped as well.
+enum class TTPages { HugeTLB, Transparent, Small, File, Shared };
+const char* tt_pages_name(TTPages pages);
+
+class TranspositionTable {
+private:
+    TTCluster* table = nullptr;
+    size_t numClusters = 0;
+    size_t allocBytes = 0;
+    size_t mbSize = 0;
+    bool interleaved = true;
+    TTPages pages = TTPages::Small;
+    uint8_t generation = 0; // bumped once per search (6 bits used), entries written earlier are stale
+
+    // Shared tables only: the object name, its inode (to not unlink a newer object of the same
+    // name) and the generation counter all attached processes bump.
+    std::string sharedName;
+    uint64_t sharedInode = 0;
+    std::atomic<uint8_t>* sharedGeneration = nullptr;
+
+    bool allocate(size_t mb); // false instead of std::bad_alloc, `table` stays null then
+    // mb if it fits, else fallbackMb (when smaller, 0 for none), else halvings down to 1 MB.
+    // Returns the size obtained, throws std::bad_alloc only if not even 1 MB is left.
+    size_t allocateFitting(size_t mb, size_t fallbackMb);
+    void release();
+    void detachShared();
+
+    static uint16_t verificationKey(uint64_t hashKey) {
+        return static_cast<uint16_t>(hashKey); // the index comes from the high bits
+    }
+
+    static uint16_t fold(uint64_t data) {
+        return static_cast<uint16_t>(data ^ (data >> 16) ^ (data >> 32) ^ (data >> 48));
+    }
+
+    // A shared table is read at its current generation, not at the one this process's last search
+    // started with, so entries written by every attached process count as current
+    uint8_t currentGeneration() const {
+        return sharedGeneration ? sharedGeneration->load(std::memory_order_relaxed) & 0x3F : generation;
+    }
+
+    // Searches since the entry was written, modulo 64
+    int age(TTData entry) const {
+        return (currentGeneration() - entry.generation()) & 0x3F;
+    }
+
+public:
+    TranspositionTable() : TranspositionTable(128) {} // 128 MB default size
+
+    // interleaved = false keeps a private table on the node of the thread that first touches it.
+    explicit TranspositionTable(size_t mb, bool interleaved = true) : interleaved(interleaved) {
+        resize(mb);
+    }
+
+    ~TranspositionTable() { release(); }
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Reallocates (huge pages where possible) and pre-faults the table, all entries empty.
+    // Zeroing is split over all cores, large tables are otherwise seconds of page faults. If mb
+    // doesn't fit, falls back to the old size and then halves it: returns the size obtained.
+    size_t resize(size_t mb);
+
+    // Resize that keeps the contents (setoption Hash). An entry only knows its cluster and the low
+    // key bits, so each new cluster takes the most valuable entries (depth minus age, as in
+    // writeEntry) of every old cluster whose key range overlaps it. Entries whose new cluster is
+    // ambiguous land in all candidates and the copies that are never probed age out. Runs on all
+    // cores and needs both tables in memory while it does. If they don't both fit, the old table
+    // is freed first and the new one starts empty, at the size resize() would get: returns false
+    // then. sizeMb() tells the size obtained.
+    bool rehash(size_t mb);
+
+    // Which pages resize() managed to get, for the `info string` after setoption Hash.
+    TTPages pageKind() const {
+        return pages;
+    }
+
+    size_t sizeMb() const {
+        return mbSize;
+    }
+
+    // Call once per search. Entries from earlier searches stay probe-able but lose their guard
+    // against shallower results, so the table stays warm across moves and games without being cleared. A shared table ages
+    // with the searches of all attached processes: a search starting anywhere makes every entry
+    // written before it one search older, for all of them.
+    void newSearch() {
+        if (sharedGeneration) generation = (sharedGeneration->fetch_add(1, std::memory_order_relaxed) + 1) & 0x3F;
+        else generation = (generation + 1) & 0x3F;
+    }
+
+    void clear(); // multi-threaded like resize()
+
+    // Snapshot for `savehash` / `loadhash`: a header (entry format version, Zobrist seed, size)
+    // followed by the raw clusters. load() maps the file copy-on-write instead of reading it, so
+    // the saved entries are used in place and the file itself never changes. Both return false
+    // on I/O errors, load() also on a file from another format or Zobrist seed; the table is
+    // left untouched then.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // Backs the table with the POSIX shared memory object `name` (e.g. "/solo-tt") so engine
+    // processes on one host search with one lock-free table. The first process creates it with
+    // `mb` MB, later ones adopt whatever size it has. Attach and detach are serialised by a file
+    // lock on the object, the last process to detach (release, resize, rehash or load) removes
+    // it. Returns false, leaving the table untouched, if the object can't be created or mapped or
+    // holds another format version / Zobrist seed.
+    bool attachShared(const std::string& name, size_t mb);
+    bool isShared() const {
+        return pages == TTPages::Shared;
+    }
+    uint32_t sharedUsers() const; // processes attached, including this one
+
+    // Number of entries
+    size_t count() const {
+        return numClusters * TT_CLUSTER_SIZE;
+    }
+
+    // Multiply-high maps the key onto [0, numClusters) without a division, for any table size.
+    TTCluster& getCluster(uint64_t hashKey) {
+        return table[static_cast<size_t>((static_cast<unsigned __int128>(hashKey) * numClusters) >> 64)];
+    }
+
+    // Starts loading the cluster of a position we are about to search, so the miss overlaps
+    // with the work done before the probe.
+    void prefetch(uint64_t hashKey) {
+        __builtin_prefetch(&getCluster(hashKey));
+    }
+
+    // Wait-free probe: copies the entry out and only reports a hit if key and data belong together.
+    bool probe(uint64_t hashKey, TTData& out) {
+        TTCluster& cluster = getCluster(hashKey);
+        const uint16_t key16 = verificationKey(hashKey);
+        for (int i = 0; i < TT_CLUSTER_SIZE; ++i) {
+            const uint64_t data = cluster.data[i].load(std::memory_order_relaxed);
+            const uint16_t key = cluster.keys[i].load(std::memory_order_relaxed);
+            if (data != 0 && (key ^ fold(data)) == key16) {
+                out = TTData(data);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Permille of sampled entries written by the current search (UCI hashfull), on a shared table
+    // since the latest search start of any attached process
+    int hashfull() const;
+
+    // Overwrites the slot already holding this position, otherwise the key's home slot in the
+    // cluster, whatever it holds: recent results beat deep old ones in this search (bench at 1 and
+    // 16 MB searched ~15% fewer nodes than with depth-preferred replacement). A fresh entry is only
+    // kept against a non-exact result at least 4 plies shallower.
+    void writeEntry(uint64_t hashKey, int16_t score, int16_t eval, int8_t depth, TTFlag flag, Move bestMove) {
+        TTCluster& cluster = getCluster(hashKey);
+        const uint16_t key16 = verificationKey(hashKey);
+        int replace = key16 % TT_CLUSTER_SIZE;
+
+        for (int i = 0; i < TT_CLUSTER_SIZE; ++i) {
+            const TTData old(cluster.data[i].load(std::memory_order_relaxed));
+            const uint16_t oldKey = cluster.keys[i].load(std::memory_order_relaxed);
+
+            if (old.raw() != 0 && (oldKey ^ fold(old.raw())) == key16) {
+                if (age(old) == 0 && flag != TT_EXACT && depth + 4 <= old.depth()) return;
+                if (bestMove == 0) bestMove = old.move();
+                replace = i;
+                break;
+            }
+        }
+
+        const uint64_t data = TTData::pack(bestMove, score, eval, depth, flag, currentGeneration()).raw();
+        cluster.data[replace].store(data, std::memory_order_relaxed);
+        cluster.keys[replace].store(key16 ^ fold(data), std::memory_order_relaxed);
+    }
+};
+
+// Global TT
+extern TranspositionTable ttTable;
+
+#endif
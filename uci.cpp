@@ -3,14 +3,18 @@
 #include "bitboard.h"
 #include "search.h"
 #include "evaluation.h"
-#include "history.h"
 #include "datagen.h"
+#include "threadpool.h"
+#include "perft.h"
+#include "numa.h"
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <charconv>
+#include <cstdlib>
 
 #include <fstream>
 
@@ -29,8 +33,13 @@ struct UciTimeParams {
 struct SearchLimit {
     int timeToThink = -1;
     int depthLimit = -1;
+    long long nodeLimit = -1;
 };
 
+static int maxThreads() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
 std::string move_to_uci(const Move m) {
         if (m == 0) return std::string("0000");
         std::string s;
@@ -50,11 +59,9 @@ std::string move_to_uci(const Move m) {
         return s;
     };
 
-void bench() {
-    const int benchDepth = 8;
-    
+static const std::vector<std::string>& bench_fens() {
     // Diverse set of positions covering opening, middlegame, endgame, and tactical themes
-    const std::vector<std::string> fens = {
+    static const std::vector<std::string> fens = {
         // Opening
         "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
         "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
@@ -77,16 +84,40 @@ void bench() {
         "4rrk1/pppb2bp/3p2p1/3Pnp2/2P1q3/2N1P1P1/PP1Q1PBP/R3R1K1 w - - 0 1",
         "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1B3/PPP1BPPP/R2Q1RK1 w - - 0 9",
     };
+    return fens;
+}
+
+// `bench [depth] [hash MB]`, the defaults (depth 8, current Hash) produce the Bench signature.
+// A small hash makes the TT replacement scheme visible in the node counts.
+void bench(int benchDepth, int hashMb) {
+    const std::vector<std::string>& fens = bench_fens();
 
     uint64_t totalNodes = 0;
     long long totalTimeMs = 0;
 
     Board board;
+    resetTTTierStats();
     if (ttTable.count() == 0) ttTable.resize(128);
-    ttTable.clear();
+    const size_t savedHashMb = ttTable.sizeMb();
+    const size_t benchHashMb = hashMb > 0 ? static_cast<size_t>(hashMb) : savedHashMb;
+
+    // Other processes are searching with a shared table, bench gets a private one instead
+    std::unique_ptr<TranspositionTable> privateTable;
+    if (ttTable.isShared()) {
+        privateTable = std::make_unique<TranspositionTable>(benchHashMb);
+        setSearchTranspositionTable(privateTable.get());
+    } else if (benchHashMb != savedHashMb) {
+        ttTable.resize(benchHashMb);
+    }
+    TranspositionTable& table = privateTable ? *privateTable : ttTable;
+    if (table.sizeMb() != benchHashMb) {
+        std::cout << "info string bench Hash " << table.sizeMb() << " MB, " << benchHashMb << " MB did not fit" << std::endl;
+    }
+    table.clear();
+    clearQSearchTables();
 
     for (size_t i = 0; i < fens.size(); ++i) {
-        clear_history();
+        clearSearchHistory();
         board.loadFEN(fens[i]);
         std::vector<uint64_t> positionHistory;
         positionHistory.reserve(64);
@@ -119,23 +150,165 @@ void bench() {
     std::cout << "bench total nodes " << totalNodes
               << " time " << safeMs << "ms nps " << totalNps
               << std::endl;
+    for (TTTier tier : {TT_TIER_MAIN, TT_TIER_QSEARCH}) {
+        const TTTierStats stats = getTTTierStats(tier);
+        std::cout << "bench tt " << (tier == TT_TIER_MAIN ? "main" : "qsearch")
+                  << " probes " << stats.probes
+                  << " hitrate " << (stats.probes > 0 ? stats.hits * 100 / stats.probes : 0) << "%"
+                  << " nodes " << stats.nodes
+                  << " nps " << stats.nodes * 1000 / safeMs
+                  << std::endl;
+    }
     std::cout << "Bench: " << totalNodes << std::endl;
+
+    if (privateTable) setSearchTranspositionTable(nullptr);
+    else if (ttTable.sizeMb() != savedHashMb) ttTable.resize(savedHashMb);
 }
 
-static uint64_t perft(Board& board, int depth) {
-    if (depth <= 0) return 1ULL;
+namespace {
 
+struct BenchInstanceResult {
     uint64_t nodes = 0;
-    int moveCount = 0;
-    Move moves[256];
-    get_all_moves(board, moves, moveCount);
-    for (int i = 0; i < moveCount; i++) {
-        board.makeMove(moves[i]);
-        nodes += perft(board, depth - 1);
-        board.unmakeMove(moves[i]);
+    long long timeMs = 0;
+};
+
+// One independent bench workload with its own worker, board and TT slice.
+BenchInstanceResult run_bench_instance(int instance, int depth, size_t hashMb) {
+    numa_bind_thread(instance); // no-op unless NUMA mode is on
+    auto worker = std::make_unique<SearchWorker>();
+    TranspositionTable tt(hashMb, false);
+    worker->setTranspositionTable(&tt);
+    Board board;
+
+    BenchInstanceResult result;
+    auto startTime = std::chrono::steady_clock::now();
+    for (const std::string& fen : bench_fens()) {
+        tt.clear();
+        worker->clearQSearchTable();
+        worker->clearHistory();
+        board.loadFEN(fen);
+        int16_t score = 0;
+        worker->getBestMove(board, depth, -1, {}, 0, true, score);
+        result.nodes += static_cast<uint64_t>(worker->getNodeCount());
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    result.timeMs = std::max<long long>(1, std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
+    return result;
+}
+
+// Runs `instances` bench workloads at once, returns the aggregate nps and prints each instance.
+long long run_concurrent_bench(int instances, int depth, size_t hashMb) {
+    std::vector<BenchInstanceResult> results(instances);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < instances; ++i) {
+        threads.emplace_back([&results, i, depth, hashMb]() {
+            results[i] = run_bench_instance(i, depth, hashMb);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    // Aggregate over the slowest instance's search time, so TT allocation isn't counted
+    uint64_t totalNodes = 0;
+    long long wallMs = 1;
+    for (int i = 0; i < instances; ++i) {
+        totalNodes += results[i].nodes;
+        wallMs = std::max(wallMs, results[i].timeMs);
+        std::cout << "info string bench instances " << instances
+                  << " instance " << (i + 1)
+                  << " time " << results[i].timeMs << "ms"
+                  << " nodes " << results[i].nodes
+                  << " nps " << (results[i].nodes * 1000) / results[i].timeMs
+                  << std::endl;
+    }
+    return static_cast<long long>((totalNodes * 1000) / wallMs);
+}
+
+} // namespace
+
+// `bench concurrent=N`: N independent bench workloads in parallel, each with a private TT slice of
+// Hash / N MB. The N=1 baseline uses the same slice size, so the only difference is the contention
+// for memory bandwidth and shared caches.
+void bench_concurrent(int instances) {
+    const int benchDepth = 8;
+    instances = std::max(1, instances);
+    const size_t hashMb = std::max<size_t>(1, ttTable.sizeMb() / instances);
+
+    const long long baseNps = run_concurrent_bench(1, benchDepth, hashMb);
+    const long long aggregateNps = (instances == 1) ? baseNps : run_concurrent_bench(instances, benchDepth, hashMb);
+
+    const double efficiency = static_cast<double>(aggregateNps) / (static_cast<double>(baseNps) * instances);
+    std::cout << "bench concurrent " << instances
+              << " hash " << hashMb << "MB per instance"
+              << " single nps " << baseNps
+              << " aggregate nps " << aggregateNps
+              << " efficiency " << static_cast<int>(efficiency * 100.0 + 0.5) << "%"
+              << std::endl;
+}
+
+// Time-to-depth comparison of the SMP modes over the bench positions with 1/2/4/8/16 threads.
+// Resizes the thread pool, so it has to run on the UCI thread rather than on a pool thread.
+void bench_smp(int depth) {
+    const std::vector<std::string>& fens = bench_fens();
+    const int threadCounts[] = {1, 2, 4, 8, 16};
+    const int savedThreads = getSearchThreads();
+    const SmpMode savedMode = getSmpMode();
+
+    if (ttTable.count() == 0) ttTable.resize(128);
+    Board board;
+
+    // As in bench(): never clear a table other processes are searching with
+    std::unique_ptr<TranspositionTable> privateTable;
+    if (ttTable.isShared()) {
+        privateTable = std::make_unique<TranspositionTable>(ttTable.sizeMb());
+        setSearchTranspositionTable(privateTable.get());
+    }
+    TranspositionTable& table = privateTable ? *privateTable : ttTable;
+
+    for (SmpMode mode : {SMP_LAZY, SMP_ABDADA}) {
+        setSmpMode(mode);
+        const char* modeName = (mode == SMP_LAZY) ? "Lazy" : "ABDADA";
+        long long baseMs = 0;
+
+        for (int threads : threadCounts) {
+            setSearchThreads(threads);
+            threadPool.resize(threads);
+
+            long long totalMs = 0;
+            uint64_t totalNodes = 0;
+            for (const std::string& fen : fens) {
+                table.clear();
+                clearSearchHistory();
+                board.loadFEN(fen);
+
+                auto startTime = std::chrono::steady_clock::now();
+                int16_t score = 0;
+                getBestMove(board, depth, -1, {}, 0, true, score, threads);
+                auto endTime = std::chrono::steady_clock::now();
+
+                totalMs += std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+                totalNodes += static_cast<uint64_t>(getNodeCounter());
+            }
+
+            totalMs = std::max<long long>(1, totalMs);
+            if (threads == 1) baseMs = totalMs;
+            std::cout << "info string smp bench mode " << modeName
+                      << " threads " << threads
+                      << " depth " << depth
+                      << " time " << totalMs << "ms"
+                      << " nodes " << totalNodes
+                      << " nps " << (totalNodes * 1000) / totalMs
+                      << " speedup " << static_cast<double>(baseMs) / totalMs
+                      << std::endl;
+        }
     }
 
-    return nodes;
+    setSmpMode(savedMode);
+    setSearchThreads(savedThreads);
+    threadPool.resize(savedThreads);
+    if (privateTable) setSearchTranspositionTable(nullptr);
+    else ttTable.clear();
+    clearSearchHistory();
 }
 
 void handle_genfens(const std::string& line) {
@@ -144,6 +317,7 @@ void handle_genfens(const std::string& line) {
     int      nodes   = 5000;   // 5k soft nodes
     bool     use_book = false;
     uint64_t seed    = 42;
+    int      hash_mb = 16;     // private TT per worker, about one game's worth of 5k-node searches
 
     std::stringstream ss(line);
     std::string token;
@@ -159,20 +333,37 @@ void handle_genfens(const std::string& line) {
         else if (key == "threads") threads = std::stoi(val);
         else if (key == "nodes")   nodes   = std::stoi(val);
         else if (key == "seed")    seed    = std::stoull(val);
+        else if (key == "hash")    hash_mb = std::max(1, std::stoi(val));
+        else if (key == "numa")    numa_set_enabled(val == "true" || val == "1");
         else if (key == "book") {
             // book=<filename> if a file is provided, enable book usage
             use_book = !val.empty() && val != "false" && val != "0";
         }
     }
 
-    start_datagen(threads, games, nodes, use_book, seed);
+    start_datagen(threads, games, nodes, use_book, seed, hash_mb);
 }
 
 int handle_uci_commands(int argc, char* argv[]){
     std::cout.setf(std::ios::unitbuf);
 
-    if (argc > 1 && std::string(argv[1]) == "bench") {
-        bench();
+    threadPool.resize(getSearchThreads());
+
+    if (argc > 2 && std::string(argv[1]) == "bench" && std::string(argv[2]).rfind("concurrent=", 0) == 0) {
+        const int instances = std::atoi(argv[2] + 11);
+        threadPool.main().run([instances]() { bench_concurrent(instances); });
+        threadPool.main().wait();
+        return 0;
+    }
+    else if (argc > 2 && std::string(argv[1]) == "bench" && std::string(argv[2]) == "smp") {
+        bench_smp(argc > 3 ? std::max(1, std::atoi(argv[3])) : 10);
+        return 0;
+    }
+    else if (argc > 1 && std::string(argv[1]) == "bench") {
+        const int depth = argc > 2 ? std::max(1, std::atoi(argv[2])) : 8;
+        const int hashMb = argc > 3 ? std::max(1, std::atoi(argv[3])) : 0;
+        threadPool.main().run([depth, hashMb]() { bench(depth, hashMb); });
+        threadPool.main().wait();
         return 0;
     }
     else if (argc > 1 && std::string(argv[1]) == "--version") {
@@ -180,7 +371,7 @@ int handle_uci_commands(int argc, char* argv[]){
         return 0;
     }
 
-    // ./Solo genfens games=10000 threads=4 nodes=5000 seed=123
+    // ./Solo genfens games=10000 threads=4 nodes=5000 seed=123 [hash=16] [numa=true]
     else if (argc > 1 && std::string(argv[1]) == "genfens") {
         std::string full_line = "genfens";
         for (int i = 2; i < argc; ++i) {
@@ -199,21 +390,29 @@ int handle_uci_commands(int argc, char* argv[]){
     gameHistory.reserve(512);
     std::string line;
 
-    std::thread searchThread;
-    std::atomic<bool> searchRunning{false};
-
-    auto join_search_if_done = [&]() {
-        if (!searchRunning.load(std::memory_order_relaxed) && searchThread.joinable()) {
-            searchThread.join();
-        }
-    };
-
+    // go, bench and perft run on the parked pool thread 0 so the loop can still react to `stop` / `isready`.
+    // A TT (re)allocation runs there as well, isready and every command that joins thread 0 wait for it.
+    bool ttResizePending = false;
+    size_t hashOptionMb = 128; // what a private table gets, a shared one has the size of its creator
     auto stop_and_join_search = [&]() {
         requestSearchStop();
-        if (searchThread.joinable()) {
-            searchThread.join();
-        }
-        searchRunning.store(false, std::memory_order_relaxed);
+        threadPool.main().wait();
+        ttResizePending = false;
+    };
+
+    // keepContents migrates the entries (setoption Hash), otherwise the table is just reallocated.
+    auto resize_tt_async = [&](size_t mb, bool keepContents) {
+        ttResizePending = true;
+        threadPool.main().run([mb, keepContents]() {
+            // Pre-faulted. Keeping what the session has searched so far needs both tables in memory at once
+            if (!keepContents) {
+                ttTable.resize(mb);
+            } else if (!ttTable.rehash(mb)) {
+                std::cout << "info string Hash contents dropped, not enough memory for both tables" << std::endl;
+            }
+            if (ttTable.sizeMb() != mb) std::cout << "info string Hash " << mb << " MB did not fit" << std::endl;
+            std::cout << "info string Hash " << ttTable.sizeMb() << " MB on " << tt_pages_name(ttTable.pageKind()) << std::endl;
+        });
     };
 
     
@@ -222,8 +421,6 @@ int handle_uci_commands(int argc, char* argv[]){
 
         UciTimeParams params;
         SearchLimit limits;
-        // If a previous search finished, clean up the thread.
-        join_search_if_done();
 
         if (line == "stop") {
             stop_and_join_search();
@@ -240,18 +437,61 @@ int handle_uci_commands(int argc, char* argv[]){
         if (line == "uci") {
             std::cout << "id name Solo " << VERSION << std::endl;
             std::cout << "id author Yunus Emre" << std::endl;
-            std::cout << "option name Hash type spin default 128 min 1 max 2048" << std::endl;
-            std::cout << "option name Threads type spin default 1 min 1 max 8" << std::endl;
+            std::cout << "option name Hash type spin default 128 min 1 max " << TT_MAX_MB << std::endl;
+            std::cout << "option name Threads type spin default 1 min 1 max " << maxThreads() << std::endl;
             std::cout << "option name Use_NNUE type check default true" << std::endl;
+            std::cout << "option name NUMA type check default false" << std::endl;
+            std::cout << "option name Log_Timing type check default false" << std::endl;
+            std::cout << "option name SMP_Mode type combo default Lazy var Lazy var ABDADA" << std::endl;
+            std::cout << "option name SharedHash type string default <empty>" << std::endl;
             std::cout << "uciok" << std::endl;
         }
         
         else if (line == "isready") {
+            if (ttResizePending) { // don't wait on a running search, only on the allocation
+                threadPool.main().wait();
+                ttResizePending = false;
+            }
             std::cout << "readyok" << std::endl;
         }
 
-        else if (line == "bench") {
-            bench();
+        else if (line.rfind("bench concurrent=", 0) == 0) {
+            stop_and_join_search();
+            const int instances = std::atoi(line.c_str() + 17);
+            threadPool.main().run([instances]() { bench_concurrent(instances); });
+            threadPool.main().wait();
+        }
+        else if (line.rfind("bench smp", 0) == 0) {
+            stop_and_join_search();
+            std::stringstream ss(line);
+            std::string token;
+            int depth = 10;
+            ss >> token >> token >> depth;
+            bench_smp(std::max(1, depth));
+        }
+        else if (line == "bench" || line.rfind("bench ", 0) == 0) {
+            stop_and_join_search();
+            std::stringstream ss(line);
+            std::string token;
+            int depth = 8;
+            int hashMb = 0;
+            ss >> token;
+            if (!(ss >> depth)) depth = 8;
+            if (!(ss >> hashMb)) hashMb = 0;
+            threadPool.main().run([depth, hashMb]() { bench(std::max(1, depth), std::max(0, hashMb)); });
+            threadPool.main().wait();
+        }
+        else if (line.rfind("savehash ", 0) == 0 || line.rfind("loadhash ", 0) == 0) {
+            stop_and_join_search();
+            const bool save = (line[0] == 's');
+            const std::string path = line.substr(9);
+            if (save ? ttTable.save(path) : ttTable.load(path)) {
+                std::cout << "info string " << (save ? "saved " : "loaded ") << ttTable.sizeMb()
+                          << " MB hash " << (save ? "to " : "from ") << path << std::endl;
+            } else {
+                std::cout << "info string " << (save ? "savehash" : "loadhash") << " failed for " << path
+                          << (save ? "" : " (missing file, or another format version / Zobrist seed)") << std::endl;
+            }
         }
         else if (line.rfind("setoption", 0) == 0) {
             std::stringstream ss(line);
@@ -276,9 +516,45 @@ int handle_uci_commands(int argc, char* argv[]){
             }
 
             if (name == "Hash") {
-                int mb = std::max(1, std::stoi(value));
-                ttTable.resize(mb);
-                ttTable.clear();
+                stop_and_join_search();
+                hashOptionMb = static_cast<size_t>(std::clamp<long long>(std::stoll(value), 1, TT_MAX_MB));
+                if (ttTable.isShared()) {
+                    std::cout << "info string Hash stays at " << ttTable.sizeMb()
+                              << " MB while SharedHash is set, " << hashOptionMb << " MB applies once it is cleared" << std::endl;
+                } else {
+                    resize_tt_async(hashOptionMb, true);
+                }
+            } else if (name == "SharedHash") {
+                stop_and_join_search();
+                if (value.empty() || value == "<empty>") {
+                    if (ttTable.isShared()) ttTable.resize(hashOptionMb); // detaches, the table is private again
+                    std::cout << "info string SharedHash off, Hash " << ttTable.sizeMb() << " MB" << std::endl;
+                } else {
+                    const std::string segment = (value[0] == '/') ? value : "/" + value;
+                    if (ttTable.attachShared(segment, hashOptionMb)) {
+                        std::cout << "info string SharedHash " << segment << ": " << ttTable.sizeMb() << " MB, "
+                                  << ttTable.sharedUsers() << " process(es) attached" << std::endl;
+                    } else {
+                        std::cout << "info string SharedHash " << segment
+                                  << " failed (no shared memory, or another format version / Zobrist seed)" << std::endl;
+                    }
+                }
+            } else if (name == "Threads") {
+                stop_and_join_search();
+                setSearchThreads(std::clamp(std::stoi(value), 1, maxThreads()));
+                threadPool.resize(getSearchThreads());
+            } else if (name == "NUMA") {
+                stop_and_join_search();
+                numa_set_enabled(value == "true");
+                threadPool.rebind();
+                std::cout << "info string NUMA " << (numa_enabled() ? "on" : "off")
+                          << ", " << numa_node_count() << " node(s) detected" << std::endl;
+                if (!ttTable.isShared()) resize_tt_async(ttTable.sizeMb(), false); // re-allocate so the pages get interleaved
+            } else if (name == "SMP_Mode") {
+                stop_and_join_search();
+                setSmpMode(value == "ABDADA" ? SMP_ABDADA : SMP_LAZY);
+            } else if (name == "Log_Timing") {
+                setLogTiming(value == "true");
             } else if (name == "Use_NNUE") {
                 USE_NNUE = (value == "true");
                 if (USE_NNUE) {
@@ -291,23 +567,42 @@ int handle_uci_commands(int argc, char* argv[]){
         
         else if (line.rfind("perft", 0) == 0) {
             stop_and_join_search();
+            // perft <depth> [threads=N] [hash=MB]
             std::stringstream ss(line);
             std::string token;
             int depth = 0;
+            int threads = 1;
+            int hashMb = 0;
             ss >> token >> depth;
+            while (ss >> token) {
+                auto eq = token.find('=');
+                if (eq == std::string::npos) continue;
+                std::string key = token.substr(0, eq);
+                std::string val = token.substr(eq + 1);
+                int number = 0;
+                const auto [end, ec] = std::from_chars(val.data(), val.data() + val.size(), number);
+                if (ec != std::errc() || end != val.data() + val.size()) {
+                    std::cout << "info string perft ignoring invalid " << token << std::endl;
+                    continue;
+                }
+                if      (key == "threads") threads = std::clamp(number, 1, maxThreads());
+                else if (key == "hash")    hashMb  = std::max(0, number);
+            }
             if (depth <= 0) {
                 std::cout << "info string perft depth missing or invalid" << std::endl;
             } else {
-                uint64_t nodes = perft(board, depth);
-                std::cout << "perft " << depth << " nodes " << nodes << std::endl;
+                if (threads > threadPool.size()) threadPool.resize(threads); // extra threads stay parked
+                threadPool.main().run([&board, depth, threads, hashMb]() {
+                    run_perft(board, depth, threads, hashMb);
+                });
+                threadPool.main().wait();
             }
         }
 
         else if (line == "ucinewgame") {
             stop_and_join_search();
-            ttTable.clear();
-            board.reset();
-            clear_history();
+            board.reset(); // the TT is aged by the next search instead of being cleared
+            clearSearchHistory();
             gameHistory.clear();
             gameHistory.push_back(position_key(board));
         }
@@ -316,7 +611,7 @@ int handle_uci_commands(int argc, char* argv[]){
             stop_and_join_search();
             if (line.find("startpos") != std::string::npos) {
                 board.reset();
-                clear_history();
+                clearSearchHistory();
             }
             else if (line.find("fen") != std::string::npos) {
                 size_t fenStart = line.find("fen") + 4;
@@ -331,7 +626,7 @@ int handle_uci_commands(int argc, char* argv[]){
             }
             gameHistory.clear();
             gameHistory.push_back(position_key(board));
-            clear_history();
+            clearSearchHistory();
             
             size_t movesPos = line.find("moves");
             if (movesPos != std::string::npos) {
@@ -350,6 +645,7 @@ int handle_uci_commands(int argc, char* argv[]){
 
         else if (line.substr(0, 2) == "go") {
             stop_and_join_search();
+            markGoReceived();
             {
                 std::stringstream ss(line);
                 std::string token;
@@ -359,6 +655,8 @@ int handle_uci_commands(int argc, char* argv[]){
                         ss >> limits.depthLimit;
                     } else if (token == "movetime") {
                         ss >> limits.timeToThink;
+                    } else if (token == "nodes") {
+                        ss >> limits.nodeLimit;
                     } else if (token == "wtime") {
                         ss >> params.wtime;
                     } else if (token == "btime") {
@@ -394,14 +692,13 @@ int handle_uci_commands(int argc, char* argv[]){
                 limits.depthLimit = 128;
             }
 
-            // Run search on a worker thread so we can still react to `stop` / `isready`.
-            searchRunning.store(true, std::memory_order_relaxed);
+            setNodeLimit(limits.nodeLimit);
 
-            
             // Get the best move within the specified limits and current position history for repetition detection.
-            searchThread = std::thread([&board, &gameHistory, depthLimit = limits.depthLimit, timeToThink = limits.timeToThink, &searchRunning]() {
+            threadPool.main().run([&board, &gameHistory, depthLimit = limits.depthLimit, timeToThink = limits.timeToThink]() {
                 int16_t score = 0;
-                Move best = getBestMove(board, depthLimit, timeToThink, gameHistory, 0, false, score);
+                Move best = getBestMove(board, depthLimit, timeToThink, gameHistory, 0, false, score, getSearchThreads());
+                logBestmoveTiming();
 
                 // If no legal move was found (mate/stalemate), output UCI null move.
                 if (best == 0) {
@@ -421,7 +718,6 @@ int handle_uci_commands(int argc, char* argv[]){
                     }
                     std::cout << std::endl;
                 }
-                searchRunning.store(false, std::memory_order_relaxed);
             });
         }
         else if (line == "quit") {
@@ -4,7 +4,9 @@
 #include "board.h"
 #include <string>
 
-void bench();
+void bench(int depth = 8, int hashMb = 0);
+void bench_smp(int depth);
+void bench_concurrent(int instances);
 extern int handle_uci_commands(int argc, char* argv[]);
 extern std::string move_to_uci(const Move m);
 #endif 
\ No newline at end of file